@@ -1,16 +1,20 @@
 #include "AudioRtBackend.h"
 #include "DX7Engine.h"
+#include "LatencyTracer.h"
+#include "PreviewCache.h"
 
 #include <iostream>
 #include <stdexcept>
 
 AudioRtBackend::AudioRtBackend(DX7Engine& engine,
                                unsigned int sampleRate,
-                               unsigned int bufferFrames)
+                               unsigned int bufferFrames,
+                               LatencyTracer* tracer)
     : audio_(),
       engine_(engine),
       sampleRate_(sampleRate),
-      bufferFrames_(bufferFrames)
+      bufferFrames_(bufferFrames),
+      tracer_(tracer)
 {
 }
 
@@ -49,6 +53,9 @@ void AudioRtBackend::start() {
             &options
         );
 
+        outputLatency_ = static_cast<double>(audio_.getStreamLatency())
+                       / sampleRate_;
+
         audio_.startStream();
         running_ = true;
     } catch (std::exception& e) {
@@ -80,7 +87,7 @@ void AudioRtBackend::stop() {
 int AudioRtBackend::audioCallback(void* outputBuffer,
                                   void* /*inputBuffer*/,
                                   unsigned int nFrames,
-                                  double /*streamTime*/,
+                                  double streamTime,
                                   RtAudioStreamStatus status,
                                   void* userData)
 {
@@ -92,5 +99,15 @@ int AudioRtBackend::audioCallback(void* outputBuffer,
     }
 
     self->engine_.render(out, static_cast<uint16_t>(nFrames));
+
+    // Trace the engine output alone; preview audio is not a played note.
+    if (self->tracer_) {
+        self->tracer_->blockRendered(out, nFrames, streamTime,
+                                     self->sampleRate_, self->outputLatency_);
+    }
+
+    if (self->preview_) {
+        self->preview_->mix(out, nFrames, self->engine_.notesStarted());
+    }
     return 0; // continue
 }
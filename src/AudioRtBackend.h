@@ -4,17 +4,24 @@
 #include <cstdint>
 
 class DX7Engine;
+class LatencyTracer;
+class PreviewPlayer;
 
 class AudioRtBackend {
 public:
     AudioRtBackend(DX7Engine& engine,
                    unsigned int sampleRate,
-                   unsigned int bufferFrames = 256);
+                   unsigned int bufferFrames = 256,
+                   LatencyTracer* tracer = nullptr);
     ~AudioRtBackend();
 
     void start();
     void stop();
 
+    // Optional: mix cached patch previews over the live engine.
+    // Set before start().
+    void setPreviewPlayer(PreviewPlayer* player) { preview_ = player; }
+
 private:
     RtAudio audio_;
     DX7Engine& engine_;
@@ -22,6 +29,10 @@ private:
     unsigned int bufferFrames_;
     bool running_ = false;
 
+    LatencyTracer* tracer_  = nullptr;
+    PreviewPlayer* preview_ = nullptr;
+    double outputLatency_ = 0.0; // seconds, as reported by the device
+
     static int audioCallback(void* outputBuffer,
                              void* inputBuffer,
                              unsigned int nFrames,
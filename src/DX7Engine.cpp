@@ -1,4 +1,5 @@
 #include "DX7Engine.h"
+#include "LatencyTracer.h"
 
 #include <fstream>
 #include <vector>
@@ -9,11 +10,20 @@
 
 DX7Engine::DX7Engine(double sampleRate, uint8_t maxNotes)
     : sampleRate_(sampleRate),
-      dexed_(maxNotes, static_cast<uint32_t>(sampleRate_))
+      maxNotes_(maxNotes)
 {
-    dexed_.activate();
-    dexed_.loadInitVoice();
-    dexed_.setGain(0.5f); // tweak to taste
+    reset();
+}
+
+void DX7Engine::reset() {
+    dexed_ = std::make_unique<DexedPlayer>(maxNotes_,
+                                           static_cast<uint32_t>(sampleRate_));
+    dexed_->activate();
+    dexed_->loadInitVoice();
+    dexed_->setGain(0.5f); // tweak to taste
+
+    eventTail_.store(eventHead_.load(std::memory_order_acquire),
+                     std::memory_order_release);
 }
 
 bool DX7Engine::extractVoice155FromSysex(const uint8_t* data,
@@ -50,31 +60,62 @@ bool DX7Engine::extractVoice155FromSysex(const uint8_t* data,
         return false;
     }
 
-    // 4. Extract the 155-byte voice parameter block
+    // 4. Only single-voice dumps (format 0) carry a VCED block; a 32-voice
+    //    bank (format 9) is packed and has to be unpacked voice by voice.
+    if (data[start + 1] != 0x43 || data[start + 3] != 0x00) {
+        std::cerr << "Not a DX7 single-voice dump (format "
+                  << int(data[start + 3]) << ")\n";
+        return false;
+    }
+
+    // 5. Extract the 155-byte voice parameter block
     const uint8_t* voice = data + start + 6;
     std::memcpy(outVoice, voice, 155);
     return true;
 }
 
-bool DX7Engine::loadVoiceFromMemory(const uint8_t* data, std::size_t len) {
+bool DX7Engine::parseVoice(const uint8_t* data,
+                           std::size_t len,
+                           uint8_t outVoice[155])
+{
     if (!data || len == 0) return false;
 
-    if (len == voiceData_.size()) {
+    if (len == 155) {
         // Already a raw 155-byte voice block
-        std::memcpy(voiceData_.data(), data, voiceData_.size());
-        dexed_.loadVoiceParameters(voiceData_.data());
+        std::memcpy(outVoice, data, 155);
         return true;
     }
 
     // Otherwise try to parse as SysEx frame (DX7 single-voice style)
-    if (!extractVoice155FromSysex(data, len, voiceData_.data())) {
+    return extractVoice155FromSysex(data, len, outVoice);
+}
+
+bool DX7Engine::loadVoiceFromMemory(const uint8_t* data, std::size_t len) {
+    std::array<uint8_t, 155> voice;
+    if (!parseVoice(data, len, voice.data())) {
         return false;
     }
 
-    dexed_.loadVoiceParameters(voiceData_.data());
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    pendingVoice_ = voice;
+    voicePending_.store(true, std::memory_order_release);
     return true;
 }
 
+void DX7Engine::applyPendingVoice() {
+    if (!voicePending_.load(std::memory_order_acquire)) return;
+
+    // Never block the audio thread: if a loader is mid-copy, try next block.
+    std::unique_lock<std::mutex> lock(pendingMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+
+    voiceData_ = pendingVoice_;
+    voicePending_.store(false, std::memory_order_relaxed);
+    lock.unlock();
+
+    dexed_->loadVoiceParameters(voiceData_.data());
+}
+
 bool DX7Engine::loadVoiceFromFile(const std::string& path) {
     std::ifstream f(path, std::ios::binary);
     if (!f) {
@@ -89,18 +130,52 @@ bool DX7Engine::loadVoiceFromFile(const std::string& path) {
     return loadVoiceFromMemory(bytes.data(), bytes.size());
 }
 
-void DX7Engine::noteOn(uint8_t note, uint8_t velocity) {
+void DX7Engine::noteOn(uint8_t note, uint8_t velocity, uint32_t traceId) {
     uint8_t v = mapVelocity(velocity);
-    dexed_.keydown(note, v);
+    if (v == 0) {
+        noteOff(note);
+        return;
+    }
+    pushEvent({note, v, traceId});
 }
 
 void DX7Engine::noteOff(uint8_t note) {
-    dexed_.keyup(note);
+    pushEvent({note, 0, 0});
+}
+
+void DX7Engine::pushEvent(const NoteEvent& ev) {
+    std::size_t head = eventHead_.load(std::memory_order_relaxed);
+    std::size_t tail = eventTail_.load(std::memory_order_acquire);
+    if (head - tail >= kEventQueueSize) {
+        return; // queue full: drop the event rather than block
+    }
+    events_[head & (kEventQueueSize - 1)] = ev;
+    eventHead_.store(head + 1, std::memory_order_release);
+}
+
+void DX7Engine::applyPendingEvents() {
+    std::size_t tail = eventTail_.load(std::memory_order_relaxed);
+    std::size_t head = eventHead_.load(std::memory_order_acquire);
+
+    for (; tail != head; ++tail) {
+        const NoteEvent& ev = events_[tail & (kEventQueueSize - 1)];
+        if (ev.velocity == 0) {
+            dexed_->keyup(ev.note);
+        } else {
+            dexed_->keydown(ev.note, ev.velocity);
+            ++notesStarted_;
+            if (tracer_) tracer_->noteApplied(ev.traceId);
+        }
+    }
+
+    eventTail_.store(tail, std::memory_order_release);
 }
 
 void DX7Engine::render(int16_t* buffer, uint16_t nFrames) {
     if (!buffer || nFrames == 0) return;
-    dexed_.render(buffer, nFrames);
+    applyPendingVoice();
+    applyPendingEvents();
+    dexed_->render(buffer, nFrames);
 }
 
 void DX7Engine::setVelocityCurve(VelocityCurve curve) {
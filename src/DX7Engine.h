@@ -3,6 +3,9 @@
 #include <cstdint>
 #include <cstddef>
 #include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include "dexed.h"  // from external/Synth_Dexed/src
@@ -27,6 +30,8 @@ enum class VelocityCurve {
     Hard        // more emphasis on high velocities
 };
 
+class LatencyTracer;
+
 class DX7Engine {
 public:
     DX7Engine(double sampleRate, uint8_t maxNotes = 16);
@@ -38,14 +43,23 @@ public:
     bool loadVoiceFromFile(const std::string& path);
 
     // Load from memory: either 155 bytes or full SysEx frame (we'll parse).
+    // Parsing happens on the calling thread; the voice is swapped in at the
+    // start of the next render() block, so this is safe while audio runs.
     bool loadVoiceFromMemory(const uint8_t* data, std::size_t len);
 
+    // Parse either of the above into a 155-byte voice without loading it.
+    static bool parseVoice(const uint8_t* data, std::size_t len,
+                           uint8_t outVoice[155]);
+
     // Velocity curve (host-side)
     void setVelocityCurve(VelocityCurve curve);
     VelocityCurve velocityCurve() const { return velCurve_; }
 
-    // MIDI-ish interface
-    void noteOn(uint8_t note, uint8_t velocity);
+    // MIDI-ish interface. Events are queued and applied at the start of the
+    // next render() block, so a single producer thread (MIDI callback) can
+    // call these while the audio thread renders.
+    // traceId is an optional LatencyTracer id for the note-on.
+    void noteOn(uint8_t note, uint8_t velocity, uint32_t traceId = 0);
     void noteOff(uint8_t note);
 
     // Render mono samples (16-bit). nFrames == number of samples.
@@ -53,17 +67,56 @@ public:
 
     double sampleRate() const { return sampleRate_; }
 
+    // Back to the freshly constructed state: a new synth instance with the
+    // init voice and no queued note events (a staged voice is kept).
+    // Offline use only: no producer may push events meanwhile, and because
+    // Synth_Dexed's constructor (re)initialises its shared lookup tables, no
+    // other engine may be rendering concurrently.
+    void reset();
+
+    // Optional: report when queued note-ons reach the synth.
+    void setTracer(LatencyTracer* tracer) { tracer_ = tracer; }
+
+    // Note-ons applied so far; read from the render thread only.
+    uint32_t notesStarted() const { return notesStarted_; }
+
 private:
-    double      sampleRate_;
-    DexedPlayer dexed_;  // engine instance
+    double                       sampleRate_;
+    uint8_t                      maxNotes_;
+    std::unique_ptr<DexedPlayer> dexed_;  // engine instance
 
     // 155-byte voice parameter block (what Synth_Dexed expects).
+    // Owned by the render thread once audio is running.
     std::array<uint8_t, 155> voiceData_;
 
+    // Voice staged by loadVoiceFromMemory(), picked up by render().
+    std::array<uint8_t, 155> pendingVoice_;
+    std::atomic<bool>        voicePending_{false};
+    std::mutex               pendingMutex_;
+
+    void applyPendingVoice();
+
     // Host-side velocity curve.
     VelocityCurve velCurve_ = VelocityCurve::LinearFull;
     uint8_t       mapVelocity(uint8_t raw) const;
 
+    // Single-producer / single-consumer note event queue.
+    struct NoteEvent {
+        uint8_t  note;
+        uint8_t  velocity; // 0 == note off
+        uint32_t traceId;
+    };
+    static constexpr std::size_t kEventQueueSize = 256; // power of two
+    std::array<NoteEvent, kEventQueueSize> events_;
+    std::atomic<std::size_t> eventHead_{0}; // advanced by the producer
+    std::atomic<std::size_t> eventTail_{0}; // advanced by render()
+
+    void pushEvent(const NoteEvent& ev);
+    void applyPendingEvents();
+
+    LatencyTracer* tracer_       = nullptr;
+    uint32_t       notesStarted_ = 0;
+
     // Extract a 155-byte DX7 voice from a SysEx buffer.
     // Mirrors your Python strip_syx() logic.
     static bool extractVoice155FromSysex(const uint8_t* data,
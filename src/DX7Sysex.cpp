@@ -0,0 +1,165 @@
+#include "DX7Sysex.h"
+
+#include <cstring>
+
+uint8_t dx7Checksum(const uint8_t* data, std::size_t len) {
+    unsigned int sum = 0;
+    for (std::size_t i = 0; i < len; ++i) sum += data[i];
+    return static_cast<uint8_t>((128 - (sum & 0x7F)) & 0x7F);
+}
+
+void dx7UnpackVoice(const uint8_t packed[128], uint8_t out[155]) {
+    // Operators are stored OP6 first in both layouts: 17 packed -> 21 bytes.
+    for (int op = 0; op < 6; ++op) {
+        const uint8_t* p = packed + op * 17;
+        uint8_t*       o = out + op * 21;
+
+        std::memcpy(o, p, 11);              // EG rates/levels, BP, depths
+        o[11] = p[11] & 0x03;               // left curve
+        o[12] = (p[11] >> 2) & 0x03;        // right curve
+        o[13] = p[12] & 0x07;               // rate scaling
+        o[20] = (p[12] >> 3) & 0x0F;        // detune
+        o[14] = p[13] & 0x03;               // amp mod sensitivity
+        o[15] = (p[13] >> 2) & 0x07;        // key velocity sensitivity
+        o[16] = p[14];                      // output level
+        o[17] = p[15] & 0x01;               // osc mode
+        o[18] = (p[15] >> 1) & 0x1F;        // freq coarse
+        o[19] = p[16];                      // freq fine
+    }
+
+    const uint8_t* p = packed + 102;
+    uint8_t*       o = out + 126;
+
+    std::memcpy(o, p, 8);                   // pitch EG rates/levels
+    o[8]  = p[8] & 0x1F;                    // algorithm
+    o[9]  = p[9] & 0x07;                    // feedback
+    o[10] = (p[9] >> 3) & 0x01;             // osc key sync
+    std::memcpy(o + 11, p + 10, 4);         // LFO speed, delay, PMD, AMD
+    o[15] = p[14] & 0x01;                   // LFO key sync
+    o[16] = (p[14] >> 1) & 0x07;            // LFO wave
+    o[17] = (p[14] >> 4) & 0x07;            // pitch mod sensitivity
+    o[18] = p[15];                          // transpose
+    std::memcpy(o + 19, p + 16, 10);        // name
+}
+
+const uint8_t* dx7FindBank(const uint8_t* data, std::size_t len) {
+    constexpr std::size_t kFrame = 6 + 4096 + 1; // header, voices, checksum
+    for (std::size_t i = 0; i + kFrame <= len; ++i) {
+        const uint8_t* p = data + i;
+        if (p[0] == 0xF0 && p[1] == 0x43 && (p[2] & 0xF0) == 0x00 &&
+            p[3] == 0x09 && p[4] == 0x20 && p[5] == 0x00) {
+            return p + 6;
+        }
+    }
+    return nullptr;
+}
+
+uint8_t dx7ParamMax(std::size_t index) {
+    // Per operator: EG rates x4, EG levels x4, break point, left/right depth,
+    // left/right curve, rate scaling, amp mod sens, velocity sens, output
+    // level, osc mode, freq coarse, freq fine, detune.
+    static const uint8_t kOpMax[21] = {
+        99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+        3, 3, 7, 3, 7, 99, 1, 31, 99, 14
+    };
+    // Pitch EG rates/levels, algorithm, feedback, osc key sync, LFO speed,
+    // delay, PMD, AMD, key sync, wave, pitch mod sens, transpose, name.
+    static const uint8_t kCommonMax[29] = {
+        99, 99, 99, 99, 99, 99, 99, 99,
+        31, 7, 1, 99, 99, 99, 99, 1, 5, 7, 48,
+        127, 127, 127, 127, 127, 127, 127, 127, 127, 127
+    };
+
+    if (index < 126) return kOpMax[index % 21];
+    if (index < 155) return kCommonMax[index - 126];
+    return 0;
+}
+
+void dx7ClampVoice(uint8_t voice[155]) {
+    for (std::size_t i = 0; i < 155; ++i) {
+        uint8_t max = dx7ParamMax(i);
+        if (voice[i] > max) voice[i] = max;
+    }
+}
+
+void dx7EncodeSingleVoice(const uint8_t voice[155], uint8_t out[163]) {
+    static const uint8_t kHeader[6] = {0xF0, 0x43, 0x00, 0x00, 0x01, 0x1B};
+    std::memcpy(out, kHeader, sizeof(kHeader));
+    std::memcpy(out + 6, voice, 155);
+    out[161] = dx7Checksum(voice, 155);
+    out[162] = 0xF7;
+}
+
+SysexParser::Result SysexParser::feed(const uint8_t* data, std::size_t len) {
+    Result result = Result::None;
+
+    for (std::size_t i = 0; i < len; ++i) {
+        uint8_t b = data[i];
+
+        if (b >= 0xF8) continue; // real-time bytes may interleave anywhere
+
+        if (b == 0xF0) {
+            inSysex_  = true;
+            overflow_ = false;
+            frameLen_ = 0;
+            frame_[frameLen_++] = b;
+            continue;
+        }
+        if (!inSysex_) continue;
+
+        if (b == 0xF7) {
+            inSysex_ = false;
+            result = finishFrame();
+            continue;
+        }
+        if (b & 0x80) {
+            // Any other status byte aborts the dump.
+            inSysex_ = false;
+            result   = isVoiceDump() ? Result::Error : Result::None;
+            continue;
+        }
+
+        if (frameLen_ < frame_.size()) {
+            frame_[frameLen_++] = b;
+        } else {
+            overflow_ = true;
+        }
+    }
+
+    return result;
+}
+
+bool SysexParser::isVoiceDump() const {
+    // The header is kept even when the rest of an oversized frame was dropped.
+    return frameLen_ >= kHeaderLen && frame_[1] == 0x43 &&
+           (frame_[2] & 0xF0) == 0x00 &&
+           (frame_[3] == 0x00 || frame_[3] == 0x09);
+}
+
+SysexParser::Result SysexParser::finishFrame() {
+    // Not a Yamaha voice-data dump: ignore rather than report an error.
+    if (!isVoiceDump()) return Result::None;
+
+    const uint8_t format = frame_[3];
+    const std::size_t count = (std::size_t(frame_[4]) << 7) | frame_[5];
+    const std::size_t expected = format == 0x00 ? 155 : 4096;
+
+    if (overflow_ || count != expected || frameLen_ != kHeaderLen + expected + 1) {
+        return Result::Error;
+    }
+
+    const uint8_t* payload = frame_.data() + kHeaderLen;
+    if (dx7Checksum(payload, expected) != frame_[kHeaderLen + expected]) {
+        return Result::Error;
+    }
+
+    if (format == 0x00) {
+        std::memcpy(voice_.data(), payload, voice_.size());
+        return Result::SingleVoice;
+    }
+
+    for (std::size_t v = 0; v < kBankVoices; ++v) {
+        dx7UnpackVoice(payload + v * 128, bank_[v].data());
+    }
+    return Result::Bank;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// DX7 voice SysEx helpers.
+//
+// Single voice:  F0 43 0n 00 01 1B <155 bytes VCED> <checksum> F7
+// 32-voice bulk: F0 43 0n 09 20 00 <32 x 128 bytes VMEM> <checksum> F7
+
+// Two's-complement checksum over the data bytes, as sent by the DX7.
+uint8_t dx7Checksum(const uint8_t* data, std::size_t len);
+
+// Unpack one 128-byte VMEM bulk voice into the 155-byte VCED layout.
+void dx7UnpackVoice(const uint8_t packed[128], uint8_t out[155]);
+
+// Locate a 32-voice bulk dump in a .syx file's bytes and return its 4096-byte
+// VMEM payload, or nullptr if data holds no complete bank.
+const uint8_t* dx7FindBank(const uint8_t* data, std::size_t len);
+
+// Largest legal value of each byte of a 155-byte VCED voice.
+uint8_t dx7ParamMax(std::size_t index);
+
+// Clamp every parameter of a voice into its legal range.
+void dx7ClampVoice(uint8_t voice[155]);
+
+// Build a 163-byte single-voice dump (channel 1) for a .syx file.
+constexpr std::size_t kDX7SingleVoiceSysexLen = 163;
+void dx7EncodeSingleVoice(const uint8_t voice[155], uint8_t out[163]);
+
+// Incremental parser for incoming DX7 voice dumps. Bytes may arrive in any
+// fragmentation (whole RtMidi messages or pieces of them); everything is
+// parsed into fixed buffers, so feed() never allocates.
+class SysexParser {
+public:
+    enum class Result {
+        None,        // nothing complete yet / not a DX7 voice dump
+        SingleVoice, // voice() holds a new 155-byte voice
+        Bank,        // bankVoice(0..31) hold a new 32-voice bank
+        Error        // malformed frame or checksum mismatch
+    };
+
+    static constexpr std::size_t kBankVoices = 32;
+
+    Result feed(const uint8_t* data, std::size_t len);
+
+    const uint8_t* voice() const { return voice_.data(); }
+    // i < kBankVoices; larger indices wrap.
+    const uint8_t* bankVoice(std::size_t i) const {
+        return bank_[i % kBankVoices].data();
+    }
+
+private:
+    static constexpr std::size_t kHeaderLen = 6;
+    static constexpr std::size_t kMaxFrame  = kHeaderLen + 4096 + 1; // + checksum
+
+    std::array<uint8_t, kMaxFrame> frame_;   // F0 .. checksum (F7 not stored)
+    std::size_t                    frameLen_ = 0;
+    bool                           inSysex_  = false;
+    bool                           overflow_ = false;
+
+    std::array<uint8_t, 155> voice_;
+    std::array<std::array<uint8_t, 155>, kBankVoices> bank_;
+
+    bool   isVoiceDump() const;
+    Result finishFrame();
+};
@@ -0,0 +1,456 @@
+#include "GoldenAudio.h"
+#include "DX7Engine.h"
+#include "OfflineRender.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr double   kSampleRate   = 48000.0;
+constexpr int      kRepeats      = 3;     // best-of timing, also checks determinism
+constexpr int      kMaxAbsError  = 16;    // in 16-bit LSBs
+constexpr double   kMinSnrDb     = 60.0;
+constexpr double   kMaxSlowdown  = 1.20;  // total render time vs. baseline
+constexpr int      kPcmStride    = 8;     // reference PCM keeps every 8th sample
+constexpr const char* kManifestHeader = "# DX7SoloAudition golden audio v2";
+
+using Voice = std::array<uint8_t, 155>;
+
+// ----------------------------------------------------------------------------
+// Corpus voices
+// ----------------------------------------------------------------------------
+
+struct OpSetup {
+    int     op;          // 1..6
+    uint8_t level;
+    uint8_t coarse;
+    uint8_t fine;
+    uint8_t detune;      // 0..14, 7 == centre
+    uint8_t rates[4];
+    uint8_t levels[4];
+    uint8_t velSens;     // 0..7
+    uint8_t ampModSens;  // 0..3
+};
+
+// The DX7 INIT VOICE in unpacked (VCED) order: OP6 first, OP1 last.
+Voice initVoice() {
+    Voice v{};
+    for (int op = 0; op < 6; ++op) {
+        uint8_t* p = v.data() + op * 21;
+        for (int i = 0; i < 4; ++i) p[i] = 99;     // EG rates
+        p[4] = 99; p[5] = 99; p[6] = 99; p[7] = 0; // EG levels
+        p[8]  = 39;                                // break point (C3)
+        p[16] = (op == 5) ? 99 : 0;                // only OP1 sounds
+        p[18] = 1;                                 // coarse
+        p[20] = 7;                                 // detune
+    }
+    uint8_t* c = v.data() + 126;
+    for (int i = 0; i < 4; ++i) c[i] = 99;         // pitch EG rates
+    for (int i = 4; i < 8; ++i) c[i] = 50;         // pitch EG levels
+    c[10] = 1;   // osc key sync
+    c[11] = 35;  // LFO speed
+    c[15] = 1;   // LFO key sync
+    c[17] = 3;   // pitch mod sens
+    c[18] = 24;  // transpose (C3)
+    const char name[] = "INIT VOICE";
+    for (int i = 0; i < 10; ++i) c[19 + i] = static_cast<uint8_t>(name[i]);
+    return v;
+}
+
+void setOp(Voice& v, const OpSetup& s) {
+    uint8_t* p = v.data() + (6 - s.op) * 21;
+    for (int i = 0; i < 4; ++i) {
+        p[i]     = s.rates[i];
+        p[4 + i] = s.levels[i];
+    }
+    p[14] = s.ampModSens;
+    p[15] = s.velSens;
+    p[16] = s.level;
+    p[18] = s.coarse;
+    p[19] = s.fine;
+    p[20] = s.detune;
+}
+
+void setCommon(Voice& v, uint8_t algorithm, uint8_t feedback, const char* name) {
+    v[134] = algorithm; // 0..31
+    v[135] = feedback;  // 0..7
+    for (int i = 0; i < 10; ++i) {
+        v[145 + i] = static_cast<uint8_t>(*name ? *name++ : ' ');
+    }
+}
+
+struct CorpusVoice {
+    const char* name;
+    Voice       data;
+};
+
+std::vector<CorpusVoice> corpusVoices() {
+    std::vector<CorpusVoice> voices;
+
+    voices.push_back({"init", initVoice()});
+
+    {
+        Voice v = initVoice();
+        setCommon(v, 4, 6, "E.PIANO");
+        setOp(v, {1, 99, 1,  0, 7, {96, 25, 25, 67}, {99, 75, 0, 0}, 2, 0});
+        setOp(v, {2, 58, 14, 0, 7, {95, 50, 35, 78}, {99, 0, 0, 0},  7, 0});
+        setOp(v, {3, 95, 1,  0, 9, {95, 29, 20, 50}, {99, 95, 0, 0}, 2, 0});
+        setOp(v, {4, 75, 1,  0, 5, {95, 20, 20, 50}, {99, 95, 0, 0}, 6, 0});
+        voices.push_back({"epiano", v});
+    }
+    {
+        Voice v = initVoice();
+        setCommon(v, 21, 7, "BRASS");
+        setOp(v, {1, 99, 1, 0, 7, {72, 76, 99, 71}, {99, 88, 96, 0}, 0, 0});
+        setOp(v, {2, 99, 1, 0, 8, {62, 51, 29, 71}, {82, 95, 96, 0}, 0, 0});
+        setOp(v, {3, 86, 1, 0, 6, {77, 76, 82, 71}, {99, 98, 98, 0}, 2, 0});
+        setOp(v, {6, 80, 1, 0, 7, {50, 40, 30, 60}, {99, 90, 80, 0}, 1, 0});
+        voices.push_back({"brass", v});
+    }
+    {
+        Voice v = initVoice();
+        setCommon(v, 4, 0, "BELL");
+        setOp(v, {1, 99, 1, 0, 7,  {99, 30, 20, 35}, {99, 60, 0, 0}, 3, 0});
+        setOp(v, {2, 80, 3, 50, 10, {99, 35, 25, 40}, {99, 50, 0, 0}, 3, 0});
+        setOp(v, {3, 90, 2, 0, 4,  {99, 40, 22, 35}, {99, 55, 0, 0}, 3, 0});
+        setOp(v, {4, 70, 7, 21, 12, {99, 45, 30, 40}, {99, 40, 0, 0}, 3, 0});
+        voices.push_back({"bell", v});
+    }
+    {
+        Voice v = initVoice();
+        setCommon(v, 0, 7, "FEEDBACK");
+        setOp(v, {1, 99, 1, 0, 7, {99, 99, 99, 99}, {99, 99, 99, 0}, 0, 0});
+        setOp(v, {3, 95, 1, 0, 7, {99, 99, 99, 80}, {99, 99, 99, 0}, 0, 0});
+        setOp(v, {4, 82, 1, 0, 7, {99, 60, 40, 80}, {99, 80, 60, 0}, 0, 0});
+        setOp(v, {6, 85, 1, 0, 7, {99, 99, 99, 80}, {99, 99, 99, 0}, 0, 0});
+        voices.push_back({"feedback", v});
+    }
+    {
+        Voice v = initVoice();
+        setCommon(v, 31, 0, "LFO");
+        setOp(v, {1, 99, 1, 0, 7, {99, 99, 99, 60}, {99, 99, 99, 0}, 0, 3});
+        setOp(v, {2, 80, 2, 0, 9, {99, 99, 99, 60}, {99, 99, 99, 0}, 0, 2});
+        v[137] = 70;  // LFO speed
+        v[139] = 40;  // pitch mod depth
+        v[140] = 60;  // amp mod depth
+        v[142] = 0;   // triangle
+        v[143] = 5;   // pitch mod sens
+        voices.push_back({"lfo", v});
+    }
+
+    return voices;
+}
+
+// ----------------------------------------------------------------------------
+// Note scripts (frames at 48 kHz)
+// ----------------------------------------------------------------------------
+
+std::vector<NoteScript> corpusScripts() {
+    std::vector<NoteScript> scripts;
+
+    scripts.push_back({"single", {{0, 60, 100}, {36000, 60, 0}}, 60000});
+
+    scripts.push_back({"chord",
+        {{0, 48, 90}, {0, 60, 90}, {0, 64, 90}, {0, 67, 90},
+         {36000, 48, 0}, {36000, 60, 0}, {36000, 64, 0}, {36000, 67, 0}},
+        60000});
+
+    scripts.push_back({"velocity",
+        {{0, 60, 20},      {9600, 60, 0},
+         {14400, 60, 64},  {24000, 60, 0},
+         {28800, 60, 127}, {38400, 60, 0}},
+        52800});
+
+    {
+        NoteScript s{"staccato", {}, 48000};
+        const uint8_t scale[8] = {60, 62, 64, 65, 67, 69, 71, 72};
+        for (uint32_t i = 0; i < 16; ++i) {
+            uint8_t note = scale[i % 8] + (i >= 8 ? 12 : 0);
+            s.events.push_back({i * 2400, note, static_cast<uint8_t>(70 + i * 3)});
+            s.events.push_back({i * 2400 + 1200, note, 0});
+        }
+        scripts.push_back(s);
+    }
+    {
+        // More notes than the engine's 16 voices: exercises voice stealing.
+        NoteScript s{"overflow", {}, 48000};
+        for (uint32_t i = 0; i < 20; ++i) {
+            s.events.push_back({i * 480, static_cast<uint8_t>(36 + i * 2), 100});
+        }
+        for (uint32_t i = 0; i < 20; ++i) {
+            s.events.push_back({36000, static_cast<uint8_t>(36 + i * 2), 0});
+        }
+        scripts.push_back(s);
+    }
+
+    return scripts;
+}
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+uint64_t fnv1a(const std::vector<int16_t>& pcm) {
+    uint64_t h = 1469598103934665603ull;
+    for (int16_t s : pcm) {
+        uint16_t u = static_cast<uint16_t>(s);
+        h = (h ^ (u & 0xFF)) * 1099511628211ull;
+        h = (h ^ (u >> 8))   * 1099511628211ull;
+    }
+    return h;
+}
+
+std::string hex64(uint64_t v) {
+    std::ostringstream os;
+    os << std::hex << std::setw(16) << std::setfill('0') << v;
+    return os.str();
+}
+
+struct Reference {
+    std::string hash;
+    std::size_t samples = 0;
+};
+
+bool readManifest(const fs::path& path, std::map<std::string, Reference>& out) {
+    std::ifstream f(path);
+    if (!f) return false;
+
+    std::string line;
+    if (!std::getline(f, line) ||
+        line != std::string(kManifestHeader) + " " + std::to_string(int(kSampleRate))) {
+        std::cerr << path.string() << ": unknown manifest header\n";
+        return false;
+    }
+    while (std::getline(f, line)) {
+        std::istringstream is(line);
+        std::string name;
+        Reference ref;
+        if (is >> name >> ref.hash >> ref.samples) out[name] = ref;
+    }
+    return true;
+}
+
+std::map<std::string, double> readTimings(const fs::path& path) {
+    std::map<std::string, double> out;
+    std::ifstream f(path);
+    std::string name;
+    double ms;
+    while (f >> name >> ms) out[name] = ms;
+    return out;
+}
+
+// Reference PCM files hold every kPcmStride-th sample of a render as 16-bit
+// little-endian words: small enough to commit, dense enough for the error
+// metrics.
+bool readPcm(const fs::path& path, std::vector<int16_t>& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(f)),
+                               std::istreambuf_iterator<char>());
+    out.resize(bytes.size() / 2);
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        out[i] = static_cast<int16_t>(bytes[2 * i] | (bytes[2 * i + 1] << 8));
+    }
+    return true;
+}
+
+bool writePcm(const fs::path& path, const std::vector<int16_t>& pcm) {
+    std::vector<uint8_t> bytes;
+    bytes.reserve((pcm.size() / kPcmStride + 1) * 2);
+    for (std::size_t i = 0; i < pcm.size(); i += kPcmStride) {
+        uint16_t u = static_cast<uint16_t>(pcm[i]);
+        bytes.push_back(static_cast<uint8_t>(u & 0xFF));
+        bytes.push_back(static_cast<uint8_t>(u >> 8));
+    }
+    std::ofstream f(path, std::ios::binary);
+    f.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return static_cast<bool>(f);
+}
+
+} // namespace
+
+int runGoldenAudio(const std::string& dir, bool update) {
+    const fs::path root(dir);
+    const fs::path manifestPath = root / "golden.txt";
+    const fs::path timingPath   = root / "timing.txt";
+
+    std::map<std::string, Reference> refs;
+    if (update) {
+        std::error_code ec;
+        fs::create_directories(root, ec);
+        if (ec) {
+            std::cerr << "Cannot create " << dir << ": " << ec.message() << "\n";
+            return 1;
+        }
+    } else if (!readManifest(manifestPath, refs)) {
+        std::cerr << "No golden references in " << dir
+                  << " (run with --golden-update first)\n";
+        return 1;
+    } else if (refs.empty()) {
+        std::cerr << "No golden references recorded in " << dir << " yet.\n"
+                     "Run --golden-update on a known-good build and commit "
+                     "the directory.\n";
+        return 1;
+    }
+
+    const std::map<std::string, double> lastTimings = readTimings(timingPath);
+    std::map<std::string, double> timings;
+
+    std::ofstream manifest;
+    if (update) {
+        manifest.open(manifestPath);
+        manifest << kManifestHeader << " " << int(kSampleRate) << "\n";
+    }
+
+    const auto voices  = corpusVoices();
+    const auto scripts = corpusScripts();
+
+    int failures = 0;
+    double totalMs = 0.0, lastTotalMs = 0.0;
+    bool haveLastTotal = !lastTimings.empty();
+
+    std::cout << std::fixed;
+
+    for (const auto& voice : voices) {
+        for (const auto& script : scripts) {
+            const std::string name = std::string(voice.name) + "-" + script.name;
+
+            std::vector<int16_t> pcm, again;
+            double bestMs = std::numeric_limits<double>::max();
+            bool deterministic = true;
+
+            for (int r = 0; r < kRepeats; ++r) {
+                DX7Engine engine(kSampleRate, 16);
+                engine.loadVoiceFromMemory(voice.data.data(), voice.data.size());
+
+                auto t0 = std::chrono::steady_clock::now();
+                renderScript(engine, script, r == 0 ? pcm : again);
+                double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - t0).count();
+                bestMs = std::min(bestMs, ms);
+
+                if (r > 0 && again != pcm) deterministic = false;
+            }
+
+            timings[name] = bestMs;
+            totalMs += bestMs;
+            auto last = lastTimings.find(name);
+            if (last != lastTimings.end()) {
+                lastTotalMs += last->second;
+            } else {
+                haveLastTotal = false;
+            }
+
+            const std::string hash = hex64(fnv1a(pcm));
+            std::cout << "  " << std::left << std::setw(20) << name << std::right;
+
+            if (!deterministic) {
+                std::cout << "FAIL  renders differ between runs\n";
+                ++failures;
+                continue;
+            }
+
+            if (update) {
+                if (!writePcm(root / (name + ".pcm"), pcm)) {
+                    std::cout << "FAIL  cannot write reference\n";
+                    ++failures;
+                    continue;
+                }
+                manifest << name << " " << hash << " " << pcm.size() << "\n";
+                std::cout << "written " << hash;
+            } else {
+                auto it = refs.find(name);
+                std::vector<int16_t> ref;
+
+                if (it == refs.end()) {
+                    std::cout << "FAIL  missing reference\n";
+                    ++failures;
+                    continue;
+                }
+                if (it->second.hash == hash) {
+                    std::cout << "identical";
+                } else if (it->second.samples != pcm.size()) {
+                    std::cout << "FAIL  length " << pcm.size()
+                              << " != " << it->second.samples << "\n";
+                    ++failures;
+                    continue;
+                } else if (!readPcm(root / (name + ".pcm"), ref) ||
+                           ref.size() != (pcm.size() + kPcmStride - 1) / kPcmStride) {
+                    std::cout << "FAIL  hash differs, PCM reference missing "
+                                 "or truncated\n";
+                    ++failures;
+                    continue;
+                } else {
+                    // Metrics over the samples the reference keeps.
+                    int maxErr = 0;
+                    double sig = 0.0, noise = 0.0;
+                    for (std::size_t i = 0; i < ref.size(); ++i) {
+                        int e = std::abs(int(pcm[i * kPcmStride]) - int(ref[i]));
+                        maxErr = std::max(maxErr, e);
+                        sig   += double(ref[i]) * ref[i];
+                        noise += double(e) * e;
+                    }
+                    double snr = 10.0 * std::log10((sig + 1.0) / (noise + 1e-12));
+                    bool ok = maxErr <= kMaxAbsError && snr >= kMinSnrDb;
+
+                    std::cout << (ok ? "close " : "FAIL  ")
+                              << "max|err|=" << maxErr
+                              << " SNR=" << std::setprecision(1) << snr << " dB";
+                    if (!ok) ++failures;
+                }
+            }
+
+            std::cout << std::setprecision(2) << "  " << bestMs << " ms";
+            if (last != lastTimings.end() && last->second > 0.0) {
+                std::cout << " (" << std::showpos << std::setprecision(0)
+                          << (bestMs / last->second - 1.0) * 100.0 << "%"
+                          << std::noshowpos << ")";
+            }
+            std::cout << "\n";
+        }
+    }
+
+    std::cout << std::setprecision(2) << "Total render time: " << totalMs << " ms";
+    if (haveLastTotal && lastTotalMs > 0.0) {
+        double ratio = totalMs / lastTotalMs;
+        std::cout << " (baseline " << lastTotalMs << " ms, x"
+                  << std::setprecision(3) << ratio << ")";
+        if (!update && ratio > kMaxSlowdown) {
+            std::cout << "\nFAIL  render time regressed by more than "
+                      << std::setprecision(0) << (kMaxSlowdown - 1.0) * 100.0 << "%";
+            ++failures;
+        }
+    }
+    std::cout << "\n";
+
+    // The timing baseline only moves with the references; otherwise a slow
+    // run would become the yardstick for the next one.
+    if (update) {
+        std::ofstream tf(timingPath);
+        for (const auto& t : timings) {
+            tf << t.first << " " << std::setprecision(4) << t.second << "\n";
+        }
+    }
+
+    if (failures) {
+        std::cout << failures << " golden check(s) failed.\n";
+        return 1;
+    }
+    std::cout << (update ? "Golden references updated.\n" : "Golden check passed.\n");
+    return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+// Golden-audio regression check.
+//
+// Renders a fixed corpus (built-in voices x note scripts) offline through
+// DX7Engine and compares every render against references stored in dir:
+//   golden.txt   case name, FNV-1a hash and length of each reference
+//   <case>.pcm   every 8th reference sample, 16-bit little-endian, for the
+//                tolerance check when a hash differs
+//   timing.txt   baseline render times, recorded with the references
+//
+// A case passes if its hash matches, or if it stays within the error
+// tolerance (max abs error and SNR). The total render time is compared with
+// the baseline and a slowdown beyond the allowed margin fails the check.
+//
+// With update == true the references are (re)written instead.
+// Returns a process exit code: 0 on pass, 1 on failure (including a
+// manifest that holds no references yet).
+int runGoldenAudio(const std::string& dir, bool update);
@@ -0,0 +1,269 @@
+#include "LatencyTracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// Anything quieter than this (about -60 dBFS) counts as silence.
+constexpr int kSilenceThreshold = 32;
+
+// Applied notes that never become audible (silent patch, zero-level
+// operators) are dropped after this long.
+constexpr int64_t kPendingTimeoutNs = 2000000000;
+
+int64_t steadyNowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(
+        steady_clock::now().time_since_epoch()).count();
+}
+
+struct NoteTimes {
+    int64_t received   = -1;
+    int64_t applied    = -1;
+    int64_t sounded    = -1;
+    uint8_t note       = 0;
+    bool    overlapped = false;
+};
+
+double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    std::size_t rank = static_cast<std::size_t>(p / 100.0 * (v.size() - 1) + 0.5);
+    return v[std::min(rank, v.size() - 1)];
+}
+
+void printStats(std::ostream& os, const char* label, const std::vector<double>& ms) {
+    os << "  " << std::left << std::setw(18) << label << std::right;
+    if (ms.empty()) {
+        os << "no samples\n";
+        return;
+    }
+    os << std::fixed << std::setprecision(2)
+       << "n=" << ms.size()
+       << "  p50=" << percentile(ms, 50.0)
+       << "  p90=" << percentile(ms, 90.0)
+       << "  p99=" << percentile(ms, 99.0)
+       << "  max=" << *std::max_element(ms.begin(), ms.end())
+       << " ms\n";
+}
+
+} // namespace
+
+void LatencyTracer::ThreadBuffer::push(const Event& ev) {
+    std::size_t n = count.load(std::memory_order_relaxed);
+    if (n >= capacity) return; // full: drop rather than allocate
+    events[n] = ev;
+    count.store(n + 1, std::memory_order_release);
+}
+
+LatencyTracer::LatencyTracer(std::size_t capacityPerThread)
+    : epochNs_(steadyNowNs())
+{
+    midiBuf_.events.reset(new Event[capacityPerThread]);
+    midiBuf_.capacity = capacityPerThread;
+    audioBuf_.events.reset(new Event[capacityPerThread]);
+    audioBuf_.capacity = capacityPerThread;
+}
+
+int64_t LatencyTracer::nowNs() const {
+    return steadyNowNs() - epochNs_;
+}
+
+uint32_t LatencyTracer::noteReceived(uint8_t note, double midiTimeStamp) {
+    if (midiBuf_.count.load(std::memory_order_relaxed) >= midiBuf_.capacity) {
+        return 0;
+    }
+    uint32_t id = nextId_++;
+    midiBuf_.push({nowNs(), id, EventType::Received, note, false, midiTimeStamp});
+    return id;
+}
+
+void LatencyTracer::noteApplied(uint32_t id) {
+    if (id == 0) return;
+
+    int64_t now = nowNs();
+    audioBuf_.push({now, id, EventType::Applied, 0, false, 0.0});
+
+    if (pendingCount_ < kMaxPending) {
+        pending_[pendingCount_]        = id;
+        pendingSinceNs_[pendingCount_] = now;
+        ++pendingCount_;
+    }
+}
+
+void LatencyTracer::blockRendered(const int16_t* out,
+                                  unsigned int nFrames,
+                                  double streamTime,
+                                  double sampleRate,
+                                  double outputLatency)
+{
+    int64_t now = nowNs();
+
+    // Map streamTime onto the steady clock. Callback scheduling jitter only
+    // ever makes the observed offset larger, so track its minimum and let it
+    // creep upwards slowly to follow drift between the two clocks.
+    double offset = now * 1e-9 - streamTime;
+    if (!haveStreamOffset_ || offset < streamOffset_ + 1e-6) {
+        streamOffset_     = offset;
+        haveStreamOffset_ = true;
+    } else {
+        streamOffset_ += 1e-6;
+    }
+
+    int peak = 0;
+    unsigned int firstLoud = nFrames;
+    for (unsigned int i = 0; i < nFrames; ++i) {
+        int a = std::abs(static_cast<int>(out[i]));
+        if (a >= kSilenceThreshold && firstLoud == nFrames) firstLoud = i;
+        if (a > peak) peak = a;
+    }
+
+    if (pendingCount_ > 0) {
+        // When something was already sounding the new note's onset can't be
+        // separated from the mix; attribute it to the start of the block and
+        // mark it so the summary can leave it out.
+        bool overlapped = prevPeak_ >= kSilenceThreshold;
+        unsigned int onset = overlapped ? 0 : firstLoud;
+
+        if (onset < nFrames) {
+            double soundSec = streamOffset_ + streamTime
+                            + onset / sampleRate + outputLatency;
+            int64_t soundNs = static_cast<int64_t>(soundSec * 1e9);
+            for (std::size_t i = 0; i < pendingCount_; ++i) {
+                audioBuf_.push({soundNs, pending_[i], EventType::Sounded,
+                                0, overlapped, streamTime});
+            }
+            pendingCount_ = 0;
+        } else {
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < pendingCount_; ++i) {
+                if (now - pendingSinceNs_[i] < kPendingTimeoutNs) {
+                    pending_[kept]        = pending_[i];
+                    pendingSinceNs_[kept] = pendingSinceNs_[i];
+                    ++kept;
+                }
+            }
+            pendingCount_ = kept;
+        }
+    }
+
+    prevPeak_ = static_cast<int16_t>(std::min(peak, 32767));
+}
+
+bool LatencyTracer::writeChromeTrace(const std::string& path) const {
+    std::ofstream f(path);
+    if (!f) {
+        std::cerr << "Failed to open trace file: " << path << "\n";
+        return false;
+    }
+
+    const std::size_t nMidi  = midiBuf_.count.load(std::memory_order_acquire);
+    const std::size_t nAudio = audioBuf_.count.load(std::memory_order_acquire);
+    std::vector<NoteTimes> notes(nextId_);
+
+    f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+      << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+         "\"args\":{\"name\":\"MIDI callback\"}},\n"
+      << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,"
+         "\"args\":{\"name\":\"Audio callback\"}},\n"
+      << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":3,"
+         "\"args\":{\"name\":\"Key-to-sound\"}}";
+
+    f << std::fixed << std::setprecision(3);
+
+    for (std::size_t i = 0; i < nMidi; ++i) {
+        const Event& e = midiBuf_.events[i];
+        notes[e.id].received = e.timeNs;
+        notes[e.id].note     = e.note;
+        f << ",\n{\"name\":\"note_on " << int(e.note)
+          << "\",\"cat\":\"midi\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":1,"
+          << "\"ts\":" << e.timeNs / 1000.0
+          << ",\"args\":{\"id\":" << e.id
+          << ",\"midi_delta_s\":" << e.arg << "}}";
+    }
+
+    for (std::size_t i = 0; i < nAudio; ++i) {
+        const Event& e = audioBuf_.events[i];
+        if (e.id >= notes.size()) continue;
+        NoteTimes& n = notes[e.id];
+
+        if (e.type == EventType::Applied) {
+            n.applied = e.timeNs;
+            f << ",\n{\"name\":\"applied " << int(n.note)
+              << "\",\"cat\":\"render\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":2,"
+              << "\"ts\":" << e.timeNs / 1000.0
+              << ",\"args\":{\"id\":" << e.id << "}}";
+        } else if (e.type == EventType::Sounded) {
+            n.sounded    = e.timeNs;
+            n.overlapped = e.overlapped;
+            f << ",\n{\"name\":\"sounded " << int(n.note)
+              << "\",\"cat\":\"output\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":2,"
+              << "\"ts\":" << e.timeNs / 1000.0
+              << ",\"args\":{\"id\":" << e.id
+              << ",\"stream_time_s\":" << e.arg
+              << ",\"overlapped\":" << (e.overlapped ? "true" : "false") << "}}";
+        }
+    }
+
+    for (std::size_t id = 1; id < notes.size(); ++id) {
+        const NoteTimes& n = notes[id];
+        if (n.received < 0 || n.sounded < 0) continue;
+        f << ",\n{\"name\":\"note " << int(n.note)
+          << "\",\"cat\":\"latency\",\"ph\":\"X\",\"pid\":1,\"tid\":3,"
+          << "\"ts\":" << n.received / 1000.0
+          << ",\"dur\":" << (n.sounded - n.received) / 1000.0
+          << ",\"args\":{\"id\":" << id
+          << ",\"overlapped\":" << (n.overlapped ? "true" : "false") << "}}";
+    }
+
+    f << "\n]}\n";
+    return static_cast<bool>(f);
+}
+
+void LatencyTracer::printSummary(std::ostream& os) const {
+    const std::size_t nMidi  = midiBuf_.count.load(std::memory_order_acquire);
+    const std::size_t nAudio = audioBuf_.count.load(std::memory_order_acquire);
+    std::vector<NoteTimes> notes(nextId_);
+
+    for (std::size_t i = 0; i < nMidi; ++i) {
+        const Event& e = midiBuf_.events[i];
+        notes[e.id].received = e.timeNs;
+    }
+    for (std::size_t i = 0; i < nAudio; ++i) {
+        const Event& e = audioBuf_.events[i];
+        if (e.id >= notes.size()) continue;
+        if (e.type == EventType::Applied) {
+            notes[e.id].applied = e.timeNs;
+        } else if (e.type == EventType::Sounded) {
+            notes[e.id].sounded    = e.timeNs;
+            notes[e.id].overlapped = e.overlapped;
+        }
+    }
+
+    std::vector<double> toApplied, toSound, total;
+    std::size_t overlapped = 0;
+    for (std::size_t id = 1; id < notes.size(); ++id) {
+        const NoteTimes& n = notes[id];
+        if (n.received < 0 || n.applied < 0) continue;
+        toApplied.push_back((n.applied - n.received) / 1e6);
+        if (n.sounded < 0) continue;
+        if (n.overlapped) {
+            ++overlapped;
+            continue;
+        }
+        toSound.push_back((n.sounded - n.applied) / 1e6);
+        total.push_back((n.sounded - n.received) / 1e6);
+    }
+
+    os << "Latency summary (" << (notes.size() - 1) << " note-ons traced, "
+       << overlapped << " overlapping notes excluded):\n";
+    printStats(os, "MIDI -> applied", toApplied);
+    printStats(os, "applied -> sound", toSound);
+    printStats(os, "MIDI -> sound", total);
+}
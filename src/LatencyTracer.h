@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+// End-to-end note latency tracing: key press (MIDI callback) -> note applied
+// inside a render block -> first non-silent sample leaving the audio callback.
+//
+// Each producing thread owns one preallocated event buffer (MIDI thread and
+// audio thread), so recording never allocates or locks. Buffers are read only
+// after the backends have been stopped, when the trace is exported.
+class LatencyTracer {
+public:
+    explicit LatencyTracer(std::size_t capacityPerThread = 1 << 16);
+
+    // MIDI thread: a note-on arrived. Returns the trace id to carry along
+    // with the note event (0 when the buffer is full).
+    uint32_t noteReceived(uint8_t note, double midiTimeStamp);
+
+    // Audio thread: a queued note-on was handed to the synth.
+    void noteApplied(uint32_t id);
+
+    // Audio thread: called after each rendered block with the final output.
+    // streamTime is RtAudio's stream clock, outputLatency the device latency.
+    void blockRendered(const int16_t* out,
+                       unsigned int nFrames,
+                       double streamTime,
+                       double sampleRate,
+                       double outputLatency);
+
+    // Export after the backends are stopped.
+    bool writeChromeTrace(const std::string& path) const;
+    void printSummary(std::ostream& os) const;
+
+private:
+    enum class EventType : uint8_t { Received, Applied, Sounded };
+
+    struct Event {
+        int64_t   timeNs;   // steady_clock, relative to tracer creation
+        uint32_t  id;
+        EventType type;
+        uint8_t   note;
+        bool      overlapped; // Sounded: other notes were already audible
+        double    arg;        // Received: RtMidi delta, Sounded: streamTime
+    };
+
+    // Single-writer event buffer.
+    struct ThreadBuffer {
+        std::unique_ptr<Event[]> events;
+        std::size_t              capacity = 0;
+        std::atomic<std::size_t> count{0};
+
+        void push(const Event& ev);
+    };
+
+    int64_t nowNs() const;
+
+    int64_t      epochNs_;
+    ThreadBuffer midiBuf_;
+    ThreadBuffer audioBuf_;
+    uint32_t     nextId_ = 1; // MIDI thread only
+
+    // Audio-thread state: notes applied but not yet heard.
+    static constexpr std::size_t kMaxPending = 64;
+    uint32_t    pending_[kMaxPending];
+    int64_t     pendingSinceNs_[kMaxPending];
+    std::size_t pendingCount_ = 0;
+    int16_t     prevPeak_     = 0;
+
+    // Offset mapping RtAudio streamTime onto the steady clock (seconds).
+    double streamOffset_    = 0.0;
+    bool   haveStreamOffset_ = false;
+
+    LatencyTracer(const LatencyTracer&) = delete;
+    LatencyTracer& operator=(const LatencyTracer&) = delete;
+};
@@ -0,0 +1,139 @@
+#include "LibraryBrowser.h"
+#include "DX7Engine.h"
+#include "PreviewCache.h"
+
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+// Lines typed on stdin. Shared with a detached reader thread, which may
+// still be blocked in getline() when the browser goes away.
+struct LibraryBrowser::InputQueue {
+    std::mutex              mutex;
+    std::deque<std::string> lines;
+
+    bool pop(std::string& line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lines.empty()) return false;
+        line = std::move(lines.front());
+        lines.pop_front();
+        return true;
+    }
+};
+
+LibraryBrowser::LibraryBrowser(DX7Engine& engine,
+                               const std::string& dir,
+                               const std::string& cachePath,
+                               double sampleRate)
+    : engine_(engine),
+      dir_(dir),
+      cachePath_(cachePath.empty()
+                     ? (std::filesystem::path(dir) / ".dx7preview.cache").string()
+                     : cachePath),
+      sampleRate_(sampleRate)
+{
+}
+
+LibraryBrowser::~LibraryBrowser() = default;
+
+bool LibraryBrowser::open() {
+    voices_ = loadVoiceLibrary(dir_);
+    if (voices_.empty()) {
+        std::cerr << "No .syx voices found in " << dir_ << "\n";
+        return false;
+    }
+
+    std::vector<uint64_t> hashes;
+    hashes.reserve(voices_.size());
+    for (const auto& v : voices_) hashes.push_back(voiceHash(v.data.data()));
+
+    cache_ = std::make_unique<PreviewCache>(sampleRate_);
+    if (cache_->open(cachePath_, hashes)) {
+        player_ = std::make_unique<PreviewPlayer>(cache_->frames());
+    } else {
+        std::cerr << "Browsing without previews.\n";
+        cache_.reset();
+    }
+
+    std::cout << "Library: " << voices_.size() << " voices in " << dir_ << "\n";
+    return true;
+}
+
+void LibraryBrowser::start() {
+    if (cache_) {
+        std::vector<std::array<uint8_t, 155>> data;
+        data.reserve(voices_.size());
+        for (const auto& v : voices_) data.push_back(v.data);
+        cache_->startRenderer(std::move(data));
+    }
+
+    input_ = std::make_shared<InputQueue>();
+    std::thread([input = input_] {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            std::lock_guard<std::mutex> lock(input->mutex);
+            input->lines.push_back(std::move(line));
+        }
+    }).detach();
+
+    std::cout << "Browse: Enter/n next, p previous, <number> jump, "
+                 "r replay, q quit.\n";
+    select(0);
+}
+
+void LibraryBrowser::select(std::size_t index) {
+    current_ = index;
+    const LibraryVoice& v = voices_[index];
+
+    engine_.loadVoiceFromMemory(v.data.data(), v.data.size());
+
+    std::cout << "[" << (index + 1) << "/" << voices_.size() << "] "
+              << std::filesystem::path(v.path).filename().string();
+    if (v.bankSlot >= 0) {
+        std::cout << " #" << (v.bankSlot + 1) << " "
+                  << std::string(v.data.begin() + 145, v.data.end());
+    }
+    std::cout << "\n";
+
+    if (!cache_) return;
+
+    player_->play(nullptr);
+    cache_->prioritize(index);
+    wantedHash_ = voiceHash(v.data.data());
+}
+
+bool LibraryBrowser::poll() {
+    std::string line;
+    while (input_ && input_->pop(line)) {
+        if (line.empty() || line == "n") {
+            select((current_ + 1) % voices_.size());
+        } else if (line == "p") {
+            select((current_ + voices_.size() - 1) % voices_.size());
+        } else if (line == "r") {
+            select(current_);
+        } else if (line == "q") {
+            return false;
+        } else {
+            try {
+                std::size_t n = std::stoul(line);
+                if (n >= 1 && n <= voices_.size()) {
+                    select(n - 1);
+                    continue;
+                }
+            } catch (...) {
+            }
+            std::cerr << "Unknown command: " << line << "\n";
+        }
+    }
+
+    if (wantedHash_) {
+        if (const PreviewClip* clip = cache_->find(wantedHash_)) {
+            cache_->makeResident(clip);
+            player_->play(clip);
+            wantedHash_ = 0;
+        }
+    }
+    return true;
+}
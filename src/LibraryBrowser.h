@@ -0,0 +1,59 @@
+#pragma once
+
+#include "VoiceLibrary.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class DX7Engine;
+class PreviewCache;
+class PreviewPlayer;
+
+// Interactive patch browsing over a directory of .syx files.
+//
+// Commands are read from stdin (Enter/n: next, p: previous, <number>: jump,
+// r: replay preview, q: quit). Each selection loads the voice into the live
+// engine and plays its cached preview straight away; previews that are not
+// rendered yet are prioritized and start as soon as they are ready.
+class LibraryBrowser {
+public:
+    LibraryBrowser(DX7Engine& engine,
+                   const std::string& dir,
+                   const std::string& cachePath,
+                   double sampleRate);
+    ~LibraryBrowser();
+
+    // Loads the library and opens the preview cache. Returns false if the
+    // directory holds no usable voices.
+    bool open();
+
+    // Player to hand to the audio backend (nullptr without a cache).
+    PreviewPlayer* player() const { return player_.get(); }
+
+    // Starts background rendering and the stdin reader; selects voice 1.
+    void start();
+
+    // Called periodically from the main loop. Returns false on quit.
+    bool poll();
+
+private:
+    struct InputQueue;
+
+    DX7Engine&   engine_;
+    std::string  dir_;
+    std::string  cachePath_;
+    double       sampleRate_;
+
+    std::vector<LibraryVoice>      voices_;
+    std::unique_ptr<PreviewCache>  cache_;
+    std::unique_ptr<PreviewPlayer> player_;
+    std::shared_ptr<InputQueue>    input_;
+
+    std::size_t current_    = 0;
+    uint64_t    wantedHash_ = 0; // preview waiting to be rendered
+
+    void select(std::size_t index);
+};
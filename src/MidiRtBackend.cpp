@@ -1,12 +1,16 @@
 #include "MidiRtBackend.h"
 #include "DX7Engine.h"
+#include "LatencyTracer.h"
 
 #include <iostream>
 #include <stdexcept>
 
-MidiRtBackend::MidiRtBackend(DX7Engine& engine, int preferredPort)
+MidiRtBackend::MidiRtBackend(DX7Engine& engine,
+                             int preferredPort,
+                             LatencyTracer* tracer)
     : midiIn_(std::make_unique<RtMidiIn>()),
-      engine_(engine)
+      engine_(engine),
+      tracer_(tracer)
 {
     unsigned int portCount = midiIn_->getPortCount();
     if (portCount == 0) {
@@ -55,7 +59,26 @@ MidiRtBackend::~MidiRtBackend() {
     }
 }
 
-void MidiRtBackend::midiCallback(double /*timeStamp*/,
+void MidiRtBackend::handleSysex(const uint8_t* data, std::size_t len) {
+    switch (sysex_.feed(data, len)) {
+    case SysexParser::Result::SingleVoice:
+        engine_.loadVoiceFromMemory(sysex_.voice(), 155);
+        singleVoices_.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case SysexParser::Result::Bank:
+        haveBank_ = true;
+        engine_.loadVoiceFromMemory(sysex_.bankVoice(0), 155);
+        banks_.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case SysexParser::Result::Error:
+        sysexErrors_.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case SysexParser::Result::None:
+        break;
+    }
+}
+
+void MidiRtBackend::midiCallback(double timeStamp,
                                  std::vector<unsigned char>* message,
                                  void* userData)
 {
@@ -67,6 +90,10 @@ void MidiRtBackend::midiCallback(double /*timeStamp*/,
     const auto& msg = *message;
     uint8_t status = msg[0];
 
+    // SysEx (or a continuation fragment of one)
+    if (status == 0xF0 || status < 0x80) {
+        self->handleSysex(msg.data(), msg.size());
+    }
     // Note On
     if ((status & 0xF0) == 0x90 && msg.size() >= 3) {
         uint8_t note = msg[1];
@@ -74,7 +101,10 @@ void MidiRtBackend::midiCallback(double /*timeStamp*/,
         if (vel == 0) {
             engine.noteOff(note);
         } else {
-            engine.noteOn(note, vel);
+            uint32_t traceId = self->tracer_
+                ? self->tracer_->noteReceived(note, timeStamp)
+                : 0;
+            engine.noteOn(note, vel, traceId);
         }
     }
     // Note Off
@@ -82,4 +112,9 @@ void MidiRtBackend::midiCallback(double /*timeStamp*/,
         uint8_t note = msg[1];
         engine.noteOff(note);
     }
+    // Program Change: pick a voice from the last received bank (0-31 only)
+    else if ((status & 0xF0) == 0xC0 && msg.size() >= 2 && self->haveBank_ &&
+             msg[1] < SysexParser::kBankVoices) {
+        engine.loadVoiceFromMemory(self->sysex_.bankVoice(msg[1]), 155);
+    }
 }
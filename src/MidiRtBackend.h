@@ -1,20 +1,42 @@
 #pragma once
 
+#include "DX7Sysex.h"
+
 #include <RtMidi.h>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <vector>
 
 class DX7Engine;
+class LatencyTracer;
 
 class MidiRtBackend {
 public:
-    explicit MidiRtBackend(DX7Engine& engine, int preferredPort = -1);
+    explicit MidiRtBackend(DX7Engine& engine,
+                           int preferredPort = -1,
+                           LatencyTracer* tracer = nullptr);
     ~MidiRtBackend();
 
+    // SysEx voice dumps received so far (for status reporting).
+    uint32_t singleVoicesReceived() const { return singleVoices_.load(); }
+    uint32_t banksReceived() const        { return banks_.load(); }
+    uint32_t sysexErrors() const          { return sysexErrors_.load(); }
+
 private:
     std::unique_ptr<RtMidiIn> midiIn_;
     DX7Engine& engine_;
+    LatencyTracer* tracer_ = nullptr;
+
+    // Incoming DX7 dumps; program changes select voices of the last bank.
+    SysexParser sysex_;
+    bool        haveBank_ = false;
+
+    std::atomic<uint32_t> singleVoices_{0};
+    std::atomic<uint32_t> banks_{0};
+    std::atomic<uint32_t> sysexErrors_{0};
+
+    void handleSysex(const uint8_t* data, std::size_t len);
 
     static void midiCallback(double timeStamp,
                              std::vector<unsigned char>* message,
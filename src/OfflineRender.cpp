@@ -0,0 +1,46 @@
+#include "OfflineRender.h"
+#include "DX7Engine.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+void renderScript(DX7Engine& engine,
+                  const NoteScript& script,
+                  std::vector<int16_t>& out,
+                  uint16_t maxBlock)
+{
+    out.resize(script.lengthFrames);
+
+    std::size_t next = 0;
+    uint32_t frame = 0;
+
+    while (frame < script.lengthFrames) {
+        while (next < script.events.size() &&
+               script.events[next].frame <= frame) {
+            const NoteScriptEvent& ev = script.events[next++];
+            if (ev.velocity == 0) {
+                engine.noteOff(ev.note);
+            } else {
+                engine.noteOn(ev.note, ev.velocity);
+            }
+        }
+
+        uint32_t end = std::min<uint32_t>(frame + maxBlock, script.lengthFrames);
+        if (next < script.events.size()) {
+            end = std::min(end, script.events[next].frame);
+        }
+
+        engine.render(out.data() + frame, static_cast<uint16_t>(end - frame));
+        frame = end;
+    }
+}
+
+void renderUntilSilent(DX7Engine& engine, int threshold, int maxBlocks) {
+    int16_t block[256];
+    for (int b = 0; b < maxBlocks; ++b) {
+        engine.render(block, 256);
+        int peak = 0;
+        for (int16_t s : block) peak = std::max(peak, std::abs(int(s)));
+        if (peak < threshold) return;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class DX7Engine;
+
+// One timed note event in an offline note script.
+struct NoteScriptEvent {
+    uint32_t frame;    // sample offset from the start of the script
+    uint8_t  note;
+    uint8_t  velocity; // 0 == note off
+};
+
+// A fixed phrase to render offline. Events must be sorted by frame.
+struct NoteScript {
+    std::string                  name;
+    std::vector<NoteScriptEvent> events;
+    uint32_t                     lengthFrames;
+};
+
+// Renders a script through engine.render() into out (resized to
+// script.lengthFrames). Blocks are split at event frames, so every event
+// lands on its exact sample regardless of the block size.
+void renderScript(DX7Engine& engine,
+                  const NoteScript& script,
+                  std::vector<int16_t>& out,
+                  uint16_t maxBlock = 256);
+
+// Renders (and discards) blocks until the output falls below threshold, so
+// the next render starts without the previous release tail. Gives up after
+// maxBlocks blocks of 256 frames.
+void renderUntilSilent(DX7Engine& engine, int threshold = 4, int maxBlocks = 400);
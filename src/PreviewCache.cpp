@@ -0,0 +1,464 @@
+#include "PreviewCache.h"
+#include "DX7Engine.h"
+#include "VoiceLibrary.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DX7_HAVE_MMAP 1
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr double   kPhraseSeconds = 1.5;
+constexpr uint32_t kEmpty         = 0;
+constexpr uint32_t kReady         = 1;
+constexpr uint32_t kVersion       = 1;
+constexpr char     kMagic[8]      = {'D', 'X', '7', 'P', 'V', 'C', 'H', '\0'};
+
+// ----------------------------------------------------------------------------
+// IMA ADPCM
+// ----------------------------------------------------------------------------
+
+const int kIndexTable[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+const int kStepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41,
+    45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190,
+    209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499,
+    2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845,
+    8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350,
+    22385, 24623, 27086, 29794, 32767
+};
+
+inline int adpcmDecode(int nibble, int& predictor, int& index) {
+    int step = kStepTable[index];
+    int diff = step >> 3;
+    if (nibble & 4) diff += step;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 1) diff += step >> 2;
+    predictor += (nibble & 8) ? -diff : diff;
+    predictor = std::clamp(predictor, -32768, 32767);
+    index = std::clamp(index + kIndexTable[nibble], 0, 88);
+    return predictor;
+}
+
+inline int adpcmEncode(int sample, int& predictor, int& index) {
+    int diff = sample - predictor;
+    int nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    int step = kStepTable[index];
+    if (diff >= step)      { nibble |= 4; diff -= step; }
+    if (diff >= step >> 1) { nibble |= 2; diff -= step >> 1; }
+    if (diff >= step >> 2) { nibble |= 1; }
+    adpcmDecode(nibble, predictor, index); // track what the decoder will see
+    return nibble;
+}
+
+inline std::atomic<uint32_t>& slotState(const PreviewClip* clip) {
+    return *reinterpret_cast<std::atomic<uint32_t>*>(
+        const_cast<uint32_t*>(&clip->state));
+}
+
+} // namespace
+
+struct PreviewCache::Header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t sampleRate;
+    uint32_t frames;
+    uint32_t slotCount;
+    uint32_t slotBytes;
+    uint32_t reserved;
+};
+
+PreviewCache::PreviewCache(double sampleRate)
+    : sampleRate_(sampleRate),
+      frames_(static_cast<uint32_t>(sampleRate * kPhraseSeconds)),
+      engine_(std::make_unique<DX7Engine>(sampleRate, 16))
+{
+    std::size_t bytes = sizeof(PreviewClip) + (frames_ + 1) / 2;
+    slotBytes_ = static_cast<uint32_t>((bytes + 7) & ~std::size_t(7));
+
+    // Standard phrase: C-E-G arpeggio, then a C major chord and its release.
+    auto at = [&](double seconds) {
+        return static_cast<uint32_t>(seconds * sampleRate);
+    };
+    phrase_.name = "preview";
+    phrase_.lengthFrames = frames_;
+    phrase_.events = {
+        {at(0.00), 60, 100}, {at(0.28), 60, 0},
+        {at(0.30), 64, 100}, {at(0.58), 64, 0},
+        {at(0.60), 67, 100}, {at(0.88), 67, 0},
+        {at(0.90), 48, 90},  {at(0.90), 60, 90},
+        {at(0.90), 64, 90},  {at(0.90), 67, 90},
+        {at(1.25), 48, 0},   {at(1.25), 60, 0},
+        {at(1.25), 64, 0},   {at(1.25), 67, 0},
+    };
+}
+
+PreviewCache::~PreviewCache() {
+    stopRenderer();
+    close();
+}
+
+PreviewClip* PreviewCache::slot(uint32_t i) const {
+    return reinterpret_cast<PreviewClip*>(
+        base_ + sizeof(Header) + std::size_t(i) * slotBytes_);
+}
+
+const PreviewClip* PreviewCache::find(uint64_t hash) const {
+    if (!base_) return nullptr;
+
+    for (uint32_t n = 0; n < slotCount_; ++n) {
+        const PreviewClip* c = slot((hash + n) & (slotCount_ - 1));
+        if (slotState(c).load(std::memory_order_acquire) != kReady) {
+            return nullptr; // an empty slot ends the probe sequence
+        }
+        if (c->hash == hash) return c;
+    }
+    return nullptr;
+}
+
+// Renderer thread only: slots are filled once and never rewritten, so
+// readers either see an empty slot or a complete clip.
+bool PreviewCache::insert(uint64_t hash, const std::vector<int16_t>& pcm) {
+    for (uint32_t n = 0; n < slotCount_; ++n) {
+        PreviewClip* c = slot((hash + n) & (slotCount_ - 1));
+        uint32_t state = slotState(c).load(std::memory_order_acquire);
+
+        if (state == kReady) {
+            if (c->hash == hash) return true;
+            continue;
+        }
+
+        int predictor = 0, index = 0;
+        c->hash      = hash;
+        c->predictor = 0;
+        c->stepIndex = 0;
+        c->reserved  = 0;
+
+        uint8_t* out = const_cast<uint8_t*>(c->adpcm());
+        for (uint32_t i = 0; i < frames_; i += 2) {
+            int lo = adpcmEncode(pcm[i], predictor, index);
+            int hi = (i + 1 < frames_) ? adpcmEncode(pcm[i + 1], predictor, index) : 0;
+            out[i / 2] = static_cast<uint8_t>(lo | (hi << 4));
+        }
+
+        slotState(c).store(kReady, std::memory_order_release);
+        return true;
+    }
+    return false; // table full
+}
+
+#ifdef DX7_HAVE_MMAP
+
+bool PreviewCache::open(const std::string& path, const std::vector<uint64_t>& hashes) {
+    close();
+
+    uint32_t wanted = 64;
+    while (wanted < hashes.size() * 2) wanted <<= 1;
+
+    // Map whatever is already there and check it matches our format.
+    Header old{};
+    uint8_t* oldBase = nullptr;
+    std::size_t oldSize = 0;
+    int oldFd = ::open(path.c_str(), O_RDWR);
+    if (oldFd >= 0) {
+        struct stat st{};
+        bool valid = fstat(oldFd, &st) == 0 &&
+                     std::size_t(st.st_size) >= sizeof(Header) &&
+                     pread(oldFd, &old, sizeof(old), 0) == ssize_t(sizeof(old)) &&
+                     std::memcmp(old.magic, kMagic, sizeof(kMagic)) == 0 &&
+                     old.version == kVersion &&
+                     old.sampleRate == uint32_t(sampleRate_) &&
+                     old.frames == frames_ &&
+                     old.slotBytes == slotBytes_ &&
+                     old.slotCount != 0 &&
+                     (old.slotCount & (old.slotCount - 1)) == 0 &&
+                     std::size_t(st.st_size) ==
+                         sizeof(Header) + std::size_t(old.slotCount) * slotBytes_;
+        if (valid) {
+            oldSize = std::size_t(st.st_size);
+            void* p = mmap(nullptr, oldSize, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, oldFd, 0);
+            if (p != MAP_FAILED) oldBase = static_cast<uint8_t*>(p);
+        }
+        if (!oldBase) {
+            std::cerr << "Preview cache " << path
+                      << " is stale or incompatible; rebuilding.\n";
+            ::close(oldFd);
+            oldFd = -1;
+        }
+    }
+
+    // Entries are never removed in place, and previews of edited voices or of
+    // other libraries sharing the file keep their slots. Reuse the table only
+    // if it stays at most half full even when every voice needs a new entry;
+    // the renderer then can't run out of slots.
+    if (oldBase) {
+        uint32_t used = 0;
+        for (uint32_t i = 0; i < old.slotCount; ++i) {
+            const auto* c = reinterpret_cast<const PreviewClip*>(
+                oldBase + sizeof(Header) + std::size_t(i) * slotBytes_);
+            if (c->state == kReady) ++used;
+        }
+        if (old.slotCount >= wanted && used + hashes.size() <= old.slotCount / 2) {
+            fd_        = oldFd;
+            base_      = oldBase;
+            mapSize_   = oldSize;
+            slotCount_ = old.slotCount;
+            return true;
+        }
+    }
+
+    // Create a new file next to the old one and move over the previews of
+    // this library's voices; everything else is dropped.
+    const std::string tmp = path + ".tmp";
+    fd_ = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    mapSize_ = sizeof(Header) + std::size_t(wanted) * slotBytes_;
+    if (fd_ < 0 || ftruncate(fd_, off_t(mapSize_)) != 0) {
+        std::cerr << "Cannot create preview cache " << tmp << ": "
+                  << std::strerror(errno) << "\n";
+        if (oldBase) munmap(oldBase, oldSize);
+        if (oldFd >= 0) ::close(oldFd);
+        close();
+        return false;
+    }
+
+    void* p = mmap(nullptr, mapSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        std::cerr << "Cannot map preview cache: " << std::strerror(errno) << "\n";
+        if (oldBase) munmap(oldBase, oldSize);
+        if (oldFd >= 0) ::close(oldFd);
+        ::close(fd_);
+        fd_ = -1;
+        mapSize_ = 0;
+        return false;
+    }
+    base_      = static_cast<uint8_t*>(p);
+    slotCount_ = wanted;
+
+    Header h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version    = kVersion;
+    h.sampleRate = uint32_t(sampleRate_);
+    h.frames     = frames_;
+    h.slotCount  = slotCount_;
+    h.slotBytes  = slotBytes_;
+    std::memcpy(base_, &h, sizeof(h));
+
+    if (oldBase) {
+        std::vector<uint64_t> keep(hashes);
+        std::sort(keep.begin(), keep.end());
+
+        for (uint32_t i = 0; i < old.slotCount; ++i) {
+            const auto* c = reinterpret_cast<const PreviewClip*>(
+                oldBase + sizeof(Header) + std::size_t(i) * slotBytes_);
+            if (c->state != kReady) continue;
+            if (!std::binary_search(keep.begin(), keep.end(), c->hash)) continue;
+
+            for (uint32_t n = 0; n < slotCount_; ++n) {
+                PreviewClip* dst = slot((c->hash + n) & (slotCount_ - 1));
+                if (dst->state == kEmpty) {
+                    std::memcpy(dst, c, slotBytes_);
+                    break;
+                }
+            }
+        }
+        munmap(oldBase, oldSize);
+        ::close(oldFd);
+    }
+
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Cannot replace preview cache " << path << ": "
+                  << std::strerror(errno) << "\n";
+    }
+    return true;
+}
+
+void PreviewCache::makeResident(const PreviewClip* clip) {
+    if (!clip || clip == pinned_) return;
+
+    const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    auto pageRange = [&](const PreviewClip* c, void*& start, std::size_t& len) {
+        uintptr_t begin = reinterpret_cast<uintptr_t>(c) & ~(uintptr_t(page) - 1);
+        uintptr_t end   = reinterpret_cast<uintptr_t>(c) + slotBytes_;
+        start = reinterpret_cast<void*>(begin);
+        len   = end - begin;
+    };
+
+    void* start;
+    std::size_t len;
+
+    if (pinned_) {
+        pageRange(pinned_, start, len);
+        munlock(start, len);
+        pinned_ = nullptr;
+    }
+
+    pageRange(clip, start, len);
+    madvise(start, len, MADV_WILLNEED);
+
+    // Read one byte per page: any major fault happens here, not in mix().
+    const volatile uint8_t* bytes = static_cast<const uint8_t*>(start);
+    uint8_t sink = 0;
+    for (std::size_t off = 0; off < len; off += page) sink ^= bytes[off];
+    sink ^= bytes[len - 1];
+    (void)sink;
+
+    // Pinning is best effort (RLIMIT_MEMLOCK); the pages were just touched.
+    if (mlock(start, len) == 0) pinned_ = clip;
+}
+
+void PreviewCache::close() {
+    pinned_ = nullptr; // munmap drops any lock
+    if (base_) munmap(base_, mapSize_);
+    if (fd_ >= 0) ::close(fd_);
+    base_      = nullptr;
+    fd_        = -1;
+    mapSize_   = 0;
+    slotCount_ = 0;
+}
+
+#else // !DX7_HAVE_MMAP
+
+bool PreviewCache::open(const std::string&, const std::vector<uint64_t>&) {
+    std::cerr << "Preview cache needs mmap (POSIX only); disabled.\n";
+    return false;
+}
+
+void PreviewCache::makeResident(const PreviewClip*) {
+}
+
+void PreviewCache::close() {
+}
+
+#endif
+
+void PreviewCache::startRenderer(std::vector<std::array<uint8_t, 155>> voices) {
+    stopRenderer();
+    if (!base_) return;
+
+    voices_ = std::move(voices);
+    done_.assign(voices_.size(), false);
+    priority_.store(-1);
+    stop_.store(false);
+    thread_ = std::thread(&PreviewCache::run, this);
+}
+
+void PreviewCache::stopRenderer() {
+    stop_.store(true);
+    if (thread_.joinable()) thread_.join();
+}
+
+void PreviewCache::prioritize(std::size_t index) {
+    priority_.store(static_cast<long>(index), std::memory_order_relaxed);
+}
+
+std::size_t PreviewCache::nextJob(std::size_t& cursor) const {
+    const long n = static_cast<long>(voices_.size());
+
+    // The selected voice first, then the ones a scroll is likely to hit next.
+    long p = priority_.load(std::memory_order_relaxed);
+    if (p >= 0) {
+        static const long kOrder[] = {0, 1, 2, -1, 3, 4, -2, 5, 6, 7, 8, -3, -4};
+        for (long d : kOrder) {
+            long i = p + d;
+            if (i >= 0 && i < n && !done_[i]) return std::size_t(i);
+        }
+    }
+
+    while (cursor < voices_.size() && done_[cursor]) ++cursor;
+    return cursor < voices_.size() ? cursor : voices_.size();
+}
+
+void PreviewCache::renderPreview(const uint8_t voice[155], std::vector<int16_t>& pcm) {
+    engine_->loadVoiceFromMemory(voice, 155);
+    renderScript(*engine_, phrase_, pcm);
+
+    // Let the release tail die out so the next preview starts from silence.
+    renderUntilSilent(*engine_);
+}
+
+void PreviewCache::run() {
+#ifdef __linux__
+    // Only use otherwise idle CPU time; never compete with the audio thread.
+    sched_param sp{};
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &sp);
+#endif
+
+    std::vector<int16_t> pcm;
+    std::size_t cursor = 0;
+    std::size_t rendered = 0;
+
+    while (!stop_.load(std::memory_order_relaxed)) {
+        std::size_t i = nextJob(cursor);
+        if (i >= voices_.size()) break;
+        done_[i] = true;
+
+        uint64_t hash = voiceHash(voices_[i].data());
+        if (find(hash)) continue;
+
+        renderPreview(voices_[i].data(), pcm);
+        if (!insert(hash, pcm)) {
+            std::cerr << "Preview cache full.\n";
+            break;
+        }
+        ++rendered;
+    }
+
+    if (rendered > 0 && !stop_.load()) {
+        std::cout << "Rendered " << rendered << " new previews.\n";
+    }
+}
+
+void PreviewPlayer::play(const PreviewClip* clip) {
+    pending_.store(clip, std::memory_order_relaxed);
+    hasPending_.store(true, std::memory_order_release);
+}
+
+void PreviewPlayer::mix(int16_t* out, unsigned int nFrames, uint32_t liveNotesStarted) {
+    if (hasPending_.exchange(false, std::memory_order_acquire)) {
+        current_   = pending_.load(std::memory_order_relaxed);
+        pos_       = 0;
+        if (current_) {
+            predictor_ = current_->predictor;
+            stepIndex_ = current_->stepIndex;
+        }
+        liveNotes_ = liveNotesStarted;
+    }
+
+    // Playing the keyboard takes over from the preview.
+    if (liveNotesStarted != liveNotes_) {
+        liveNotes_ = liveNotesStarted;
+        current_   = nullptr;
+    }
+    if (!current_) return;
+
+    const uint8_t* data = current_->adpcm();
+    for (unsigned int i = 0; i < nFrames && pos_ < frames_; ++i, ++pos_) {
+        int nibble = (pos_ & 1) ? (data[pos_ >> 1] >> 4) : (data[pos_ >> 1] & 0x0F);
+        int s = out[i] + adpcmDecode(nibble, predictor_, stepIndex_);
+        out[i] = static_cast<int16_t>(std::clamp(s, -32768, 32767));
+    }
+    if (pos_ >= frames_) current_ = nullptr;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "OfflineRender.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class DX7Engine;
+
+// One cached preview inside the cache file: a header followed by the
+// standard phrase as 4-bit IMA ADPCM ((frames + 1) / 2 bytes).
+struct PreviewClip {
+    uint64_t hash;      // voiceHash() of the 155-byte voice
+    uint32_t state;     // empty / ready; accessed atomically
+    int16_t  predictor; // ADPCM decoder start state
+    uint8_t  stepIndex;
+    uint8_t  reserved;
+
+    const uint8_t* adpcm() const {
+        return reinterpret_cast<const uint8_t*>(this + 1);
+    }
+};
+
+// Pre-rendered previews for patch browsing.
+//
+// All previews live in a single memory-mapped file of fixed-size slots,
+// open-addressed by voice content hash, so renaming or duplicating .syx files
+// costs nothing and previews survive restarts. A background thread running at
+// idle priority renders the missing ones with its own engine; browsing only
+// looks clips up and hands them to a PreviewPlayer.
+class PreviewCache {
+public:
+    explicit PreviewCache(double sampleRate);
+    ~PreviewCache();
+
+    // Maps a cache with room for previews of all the given voice hashes,
+    // creating it or rebuilding it (keeping only those voices' previews) when
+    // the existing file could fill up. POSIX only; returns false elsewhere or
+    // on I/O errors.
+    bool open(const std::string& path, const std::vector<uint64_t>& hashes);
+
+    uint32_t frames() const { return frames_; }
+
+    // Ready preview for a voice hash, or nullptr. Safe from any thread.
+    const PreviewClip* find(uint64_t hash) const;
+
+    // UI thread, before handing a clip to the player: fault its pages in
+    // and pin them, so the audio callback never takes a page fault on the
+    // file-backed mapping. Unpins the previously pinned clip.
+    void makeResident(const PreviewClip* clip);
+
+    // Render previews for all voices in the background, in order, jumping to
+    // prioritize()d indices (and their neighbours) first.
+    void startRenderer(std::vector<std::array<uint8_t, 155>> voices);
+    void stopRenderer();
+    void prioritize(std::size_t index);
+
+private:
+    struct Header;
+
+    double      sampleRate_;
+    uint32_t    frames_;
+    uint32_t    slotBytes_;
+    NoteScript  phrase_;
+
+    int         fd_        = -1;
+    uint8_t*    base_      = nullptr;
+    std::size_t mapSize_   = 0;
+    uint32_t    slotCount_ = 0;
+
+    const PreviewClip* pinned_ = nullptr;
+
+    std::unique_ptr<DX7Engine>            engine_; // renderer thread only
+    std::vector<std::array<uint8_t, 155>> voices_;
+    std::vector<bool>                     done_;
+    std::atomic<long>                     priority_{-1};
+    std::atomic<bool>                     stop_{false};
+    std::thread                           thread_;
+
+    PreviewClip* slot(uint32_t i) const;
+    bool         insert(uint64_t hash, const std::vector<int16_t>& pcm);
+    void         close();
+    void         run();
+    std::size_t  nextJob(std::size_t& cursor) const;
+    void         renderPreview(const uint8_t voice[155], std::vector<int16_t>& pcm);
+
+    PreviewCache(const PreviewCache&) = delete;
+    PreviewCache& operator=(const PreviewCache&) = delete;
+};
+
+// Plays cached previews on the audio thread, mixed over the live engine.
+// Decoding ADPCM is the only work done there; any live note-on stops it.
+class PreviewPlayer {
+public:
+    explicit PreviewPlayer(uint32_t frames) : frames_(frames) {}
+
+    // UI thread: start a clip (nullptr stops playback).
+    void play(const PreviewClip* clip);
+
+    // Audio thread: add the preview into out.
+    void mix(int16_t* out, unsigned int nFrames, uint32_t liveNotesStarted);
+
+private:
+    uint32_t frames_;
+
+    std::atomic<const PreviewClip*> pending_{nullptr};
+    std::atomic<bool>               hasPending_{false};
+
+    // Audio thread state
+    const PreviewClip* current_   = nullptr;
+    uint32_t           pos_       = 0;
+    int                predictor_ = 0;
+    int                stepIndex_ = 0;
+    uint32_t           liveNotes_ = 0;
+};
@@ -0,0 +1,243 @@
+#include "VoiceBreeder.h"
+#include "DX7Engine.h"
+#include "DX7Sysex.h"
+#include "OfflineRender.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Voice = std::array<uint8_t, 155>;
+
+// Rejection thresholds, on 16-bit samples.
+constexpr double   kMinRms          = 100.0;   // about -50 dBFS
+constexpr int      kClipLevel       = 32000;
+constexpr double   kMaxClipFraction = 0.001;
+constexpr double   kMaxDcRatio      = 0.25;    // |mean| / rms
+
+enum class Verdict { Keep, Silent, Clipped, DcHeavy };
+
+// splitmix64: tiny, fast and good enough for parameter noise. Seeded per
+// candidate so results do not depend on scheduling.
+struct Rng {
+    uint64_t state;
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    std::size_t below(std::size_t n) { return static_cast<std::size_t>(next() % n); }
+};
+
+void mutate(Voice& v, Rng& rng, double rate) {
+    for (std::size_t i = 0; i < 145; ++i) { // leave the name alone
+        if (rng.uniform() >= rate) continue;
+
+        int max = dx7ParamMax(i);
+        int value;
+        if (max <= 7) {
+            // Switches and small enums: any legal value.
+            value = static_cast<int>(rng.below(max + 1));
+        } else {
+            // Continuous parameters: a step of roughly +-max/8, triangular.
+            double step = (rng.uniform() - rng.uniform()) * (max / 4.0);
+            value = v[i] + static_cast<int>(std::lround(step));
+        }
+        v[i] = static_cast<uint8_t>(std::clamp(value, 0, max));
+    }
+}
+
+Voice crossover(const Voice& a, const Voice& b, Rng& rng) {
+    Voice child = a;
+    // Whole operators travel together; they only make sense as a unit.
+    for (int op = 0; op < 6; ++op) {
+        if (rng.next() & 1) {
+            std::copy_n(b.begin() + op * 21, 21, child.begin() + op * 21);
+        }
+    }
+    // Pitch EG, algorithm/feedback, LFO: three groups from either parent.
+    const std::size_t groups[][2] = {{126, 134}, {134, 137}, {137, 145}};
+    for (const auto& g : groups) {
+        if (rng.next() & 1) {
+            std::copy(b.begin() + g[0], b.begin() + g[1], child.begin() + g[0]);
+        }
+    }
+    return child;
+}
+
+// One pass over contiguous int16 data with no branches in the body. The
+// reductions are declared to the compiler (-fopenmp-simd, see CMakeLists.txt)
+// so the loop is vectorized at -O2 as well, not only at -O3.
+Verdict screen(const std::vector<int16_t>& pcm) {
+    const std::size_t n = pcm.size();
+    const int16_t* x = pcm.data();
+
+    int64_t  sum = 0;
+    int64_t  sumSq = 0;
+    uint32_t clipped = 0;
+    #pragma omp simd reduction(+:sum, sumSq, clipped)
+    for (std::size_t i = 0; i < n; ++i) {
+        int32_t s = x[i];
+        sum     += s;
+        sumSq   += int64_t(s) * s;
+        clipped += static_cast<uint32_t>((s >= kClipLevel) | (s <= -kClipLevel));
+    }
+
+    double mean = double(sum) / n;
+    double rms  = std::sqrt(double(sumSq) / n);
+
+    if (rms < kMinRms) return Verdict::Silent;
+    if (clipped > kMaxClipFraction * n) return Verdict::Clipped;
+    if (std::fabs(mean) > kMaxDcRatio * rms) return Verdict::DcHeavy;
+    return Verdict::Keep;
+}
+
+NoteScript evaluationScript(double sampleRate) {
+    auto at = [&](double seconds) {
+        return static_cast<uint32_t>(seconds * sampleRate);
+    };
+    // Low and mid notes at two velocities, then a chord: enough to catch
+    // patches that only misbehave in one register or at full velocity.
+    return {"breed",
+            {{at(0.00), 36, 64},  {at(0.25), 36, 0},
+             {at(0.25), 60, 127}, {at(0.50), 60, 0},
+             {at(0.50), 48, 100}, {at(0.50), 55, 100},
+             {at(0.50), 64, 100}, {at(0.90), 48, 0},
+             {at(0.90), 55, 0},   {at(0.90), 64, 0}},
+            at(1.0)};
+}
+
+// Candidates rendered per worker between two rounds of engine resets.
+constexpr std::size_t kRoundPerThread = 16;
+
+struct Worker {
+    std::vector<int16_t>       pcm;
+    std::vector<std::pair<std::size_t, Voice>> survivors;
+};
+
+} // namespace
+
+int runVoiceBreeder(const std::vector<Voice>& parents, const BreedOptions& options) {
+    if (parents.empty()) {
+        std::cerr << "Breeding needs at least one parent voice "
+                     "(--voice or --library).\n";
+        return 1;
+    }
+
+    std::error_code ec;
+    fs::create_directories(options.outDir, ec);
+    if (ec) {
+        std::cerr << "Cannot create " << options.outDir << ": " << ec.message() << "\n";
+        return 1;
+    }
+
+    unsigned int threads = options.threads
+        ? options.threads
+        : std::max(1u, std::thread::hardware_concurrency());
+    WorkStealingPool pool(threads);
+
+    // Every candidate renders on a freshly reset engine (LFO phase, voice
+    // rotation, no leftover tail), so its render and verdict don't depend on
+    // what ran before it. Synth_Dexed (re)initialises shared lookup tables
+    // when an engine is built, so that can't overlap any render: candidates
+    // are processed in rounds, with one engine per candidate of the round,
+    // reset here on this thread while the pool is idle. That part is serial,
+    // so its share of the run is timed and reported.
+    std::vector<Worker> workers(pool.threads());
+    const std::size_t round =
+        std::min<std::size_t>(kRoundPerThread * pool.threads(), options.count);
+    std::vector<std::unique_ptr<DX7Engine>> engines;
+    for (std::size_t i = 0; i < round; ++i) {
+        engines.push_back(std::make_unique<DX7Engine>(options.sampleRate, 16));
+    }
+
+    const NoteScript script = evaluationScript(options.sampleRate);
+    std::atomic<std::size_t> silent{0}, clipped{0}, dcHeavy{0};
+
+    auto t0 = std::chrono::steady_clock::now();
+    double resetSeconds = 0.0;
+
+    for (std::size_t start = 0; start < options.count; start += round) {
+        const std::size_t n = std::min(round, options.count - start);
+        if (start > 0) {
+            auto r0 = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < n; ++i) engines[i]->reset();
+            resetSeconds += std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - r0).count();
+        }
+
+        pool.run(n, [&](unsigned int self, std::size_t slot) {
+            const std::size_t index = start + slot;
+            DX7Engine& engine = *engines[slot];
+            Worker& w = workers[self];
+            Rng rng{options.seed * 0x2545F4914F6CDD1Dull + index};
+
+            Voice child;
+            const Voice& a = parents[rng.below(parents.size())];
+            if (parents.size() > 1 && (rng.next() & 1)) {
+                child = crossover(a, parents[rng.below(parents.size())], rng);
+            } else {
+                child = a;
+            }
+            dx7ClampVoice(child.data());
+            mutate(child, rng, options.mutationRate);
+
+            char name[11];
+            std::snprintf(name, sizeof(name), "BRD%07zu", index % 10000000);
+            std::copy_n(name, 10, child.begin() + 145);
+
+            engine.loadVoiceFromMemory(child.data(), child.size());
+            renderScript(engine, script, w.pcm);
+
+            switch (screen(w.pcm)) {
+            case Verdict::Keep:    w.survivors.emplace_back(index, child); break;
+            case Verdict::Silent:  ++silent;  break;
+            case Verdict::Clipped: ++clipped; break;
+            case Verdict::DcHeavy: ++dcHeavy; break;
+            }
+        });
+    }
+
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - t0).count();
+
+    std::size_t written = 0;
+    for (const auto& w : workers) {
+        for (const auto& s : w.survivors) {
+            uint8_t sysex[kDX7SingleVoiceSysexLen];
+            dx7EncodeSingleVoice(s.second.data(), sysex);
+
+            char file[32];
+            std::snprintf(file, sizeof(file), "breed_%06zu.syx", s.first);
+            std::ofstream f(fs::path(options.outDir) / file, std::ios::binary);
+            f.write(reinterpret_cast<const char*>(sysex), sizeof(sysex));
+            if (f) ++written;
+        }
+    }
+
+    std::cout << "Evaluated " << options.count << " candidates from "
+              << parents.size() << " parent(s) on " << pool.threads()
+              << " thread(s) in " << seconds << " s ("
+              << static_cast<long>(options.count / std::max(seconds, 1e-9) * 60.0)
+              << " per minute), " << resetSeconds
+              << " s of it resetting engines on one thread.\n"
+              << "Rejected: " << silent << " silent, " << clipped << " clipped, "
+              << dcHeavy << " DC-heavy.\n"
+              << "Wrote " << written << " voices to " << options.outDir << "\n";
+    return 0;
+}
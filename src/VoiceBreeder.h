@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Offline patch generator.
+//
+// Every candidate is either a mutated copy of one parent or an operator-wise
+// crossover of two parents followed by mutation, with all parameters kept in
+// their legal DX7 ranges. Candidates are rendered through DX7Engine on a
+// work-stealing pool, each on a freshly reset engine, and screened with
+// cheap signal checks; silent, clipping or DC-heavy results are rejected and
+// the survivors are written to outDir as single-voice .syx files.
+struct BreedOptions {
+    std::string  outDir;
+    std::size_t  count        = 1000;
+    uint64_t     seed         = 1;
+    unsigned int threads      = 0;    // 0 == hardware concurrency
+    double       mutationRate = 0.08; // per parameter
+    double       sampleRate   = 48000.0;
+};
+
+// Returns a process exit code.
+int runVoiceBreeder(const std::vector<std::array<uint8_t, 155>>& parents,
+                    const BreedOptions& options);
@@ -0,0 +1,83 @@
+#include "VoiceLibrary.h"
+#include "DX7Engine.h"
+#include "DX7Sysex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+bool isSyxFile(const std::string& name) {
+    if (name.size() < 4) return false;
+    std::string ext = name.substr(name.size() - 4);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return ext == ".syx";
+}
+
+uint64_t voiceHash(const uint8_t voice[155]) {
+    uint64_t h = 1469598103934665603ull;
+    for (int i = 0; i < 155; ++i) {
+        h = (h ^ voice[i]) * 1099511628211ull;
+    }
+    return h ? h : 1;
+}
+
+bool loadVoiceFile(const std::string& path, std::vector<LibraryVoice>& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) {
+        std::cerr << "Cannot open voice file: " << path << "\n";
+        return false;
+    }
+    std::vector<uint8_t> bytes(
+        (std::istreambuf_iterator<char>(f)),
+        std::istreambuf_iterator<char>());
+
+    if (const uint8_t* bank = dx7FindBank(bytes.data(), bytes.size())) {
+        for (int i = 0; i < 32; ++i) {
+            LibraryVoice v;
+            v.path     = path;
+            v.bankSlot = i;
+            dx7UnpackVoice(bank + i * 128, v.data.data());
+            out.push_back(std::move(v));
+        }
+        return true;
+    }
+
+    LibraryVoice v;
+    v.path = path;
+    if (!DX7Engine::parseVoice(bytes.data(), bytes.size(), v.data.data())) {
+        std::cerr << "Skipping unreadable voice: " << path << "\n";
+        return false;
+    }
+    out.push_back(std::move(v));
+    return true;
+}
+
+std::vector<LibraryVoice> loadVoiceLibrary(const std::string& dir) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file() && isSyxFile(entry.path().filename().string())) {
+            paths.push_back(entry.path().string());
+        }
+    }
+    if (ec) {
+        std::cerr << "Cannot read voice library " << dir << ": "
+                  << ec.message() << "\n";
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<LibraryVoice> voices;
+    voices.reserve(paths.size());
+
+    for (const auto& path : paths) {
+        loadVoiceFile(path, voices);
+    }
+
+    return voices;
+}
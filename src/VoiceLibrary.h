@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A directory of .syx files (single voices or 32-voice banks), parsed up front.
+struct LibraryVoice {
+    std::string              path;
+    int                      bankSlot = -1; // 0..31 for a voice from a bank
+    std::array<uint8_t, 155> data;
+};
+
+// True for names ending in .syx (any case).
+bool isSyxFile(const std::string& name);
+
+// Content hash of a 155-byte voice (FNV-1a 64, never 0).
+uint64_t voiceHash(const uint8_t voice[155]);
+
+// Appends the voices of one file: a raw 155-byte voice, a single-voice dump,
+// or all 32 voices of a bulk dump. Reports and returns false if the file
+// cannot be read or holds no voice.
+bool loadVoiceFile(const std::string& path, std::vector<LibraryVoice>& out);
+
+// Loads every parseable .syx file in dir, sorted by file name.
+// Unreadable or malformed files are reported and skipped.
+std::vector<LibraryVoice> loadVoiceLibrary(const std::string& dir);
@@ -0,0 +1,185 @@
+#include "VoiceWatcher.h"
+#include "DX7Engine.h"
+#include "VoiceLibrary.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string normalizedDir(const std::string& dir) {
+    std::error_code ec;
+    fs::path p = fs::absolute(dir, ec);
+    if (ec) p = dir;
+    return p.lexically_normal().string();
+}
+
+} // namespace
+
+VoiceWatcher::VoiceWatcher(DX7Engine& engine,
+                           const std::string& voicePath,
+                           const std::string& watchDir)
+    : engine_(engine)
+{
+    if (!voicePath.empty()) {
+        fs::path p = fs::path(voicePath);
+        fs::path parent = p.parent_path();
+        voiceDir_  = normalizedDir(parent.empty() ? "." : parent.string());
+        voiceName_ = p.filename().string();
+    }
+    if (!watchDir.empty()) {
+        watchDir_ = normalizedDir(watchDir);
+    }
+}
+
+VoiceWatcher::~VoiceWatcher() {
+    stop();
+}
+
+bool VoiceWatcher::wantsFile(const std::string& dir,
+                             const std::string& name) const
+{
+    if (!voiceName_.empty() && dir == voiceDir_ && name == voiceName_) {
+        return true;
+    }
+    return !watchDir_.empty() && dir == watchDir_ && isSyxFile(name);
+}
+
+#ifdef __linux__
+
+bool VoiceWatcher::addWatch(const std::string& dir) {
+    for (const auto& w : watches_) {
+        if (w.second == dir) return true;
+    }
+
+    // IN_CLOSE_WRITE: saved in place. IN_MOVED_TO: saved via temp + rename.
+    int wd = inotify_add_watch(inotifyFd_, dir.c_str(),
+                               IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0) {
+        std::cerr << "Cannot watch " << dir << ": "
+                  << std::strerror(errno) << "\n";
+        return false;
+    }
+    watches_.emplace_back(wd, dir);
+    return true;
+}
+
+bool VoiceWatcher::start() {
+    if (thread_.joinable()) return true;
+
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd_    = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd_ < 0 || wakeFd_ < 0) {
+        std::cerr << "inotify unavailable: " << std::strerror(errno) << "\n";
+        stop();
+        return false;
+    }
+
+    bool ok = false;
+    if (!voiceDir_.empty()) ok |= addWatch(voiceDir_);
+    if (!watchDir_.empty()) ok |= addWatch(watchDir_);
+    if (!ok) {
+        stop();
+        return false;
+    }
+
+    thread_ = std::thread(&VoiceWatcher::run, this);
+    return true;
+}
+
+void VoiceWatcher::stop() {
+    if (thread_.joinable()) {
+        uint64_t one = 1;
+        ssize_t r = write(wakeFd_, &one, sizeof(one));
+        (void)r;
+        thread_.join();
+    }
+    if (inotifyFd_ >= 0) close(inotifyFd_);
+    if (wakeFd_ >= 0)    close(wakeFd_);
+    inotifyFd_ = -1;
+    wakeFd_    = -1;
+    watches_.clear();
+}
+
+void VoiceWatcher::run() {
+    alignas(struct inotify_event) char buf[4096];
+    pollfd fds[2] = {
+        { inotifyFd_, POLLIN, 0 },
+        { wakeFd_,    POLLIN, 0 },
+    };
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Voice watcher poll error: "
+                      << std::strerror(errno) << "\n";
+            return;
+        }
+        if (fds[1].revents) return; // stop() requested
+
+        // Drain everything queued so a burst of writes reloads only once.
+        std::string changed;
+        for (;;) {
+            ssize_t n = read(inotifyFd_, buf, sizeof(buf));
+            if (n <= 0) break;
+
+            for (char* p = buf; p < buf + n; ) {
+                const auto* ev = reinterpret_cast<const inotify_event*>(p);
+                p += sizeof(inotify_event) + ev->len;
+                if (ev->len == 0) continue;
+
+                for (const auto& w : watches_) {
+                    if (w.first == ev->wd && wantsFile(w.second, ev->name)) {
+                        changed = (fs::path(w.second) / ev->name).string();
+                        break;
+                    }
+                }
+            }
+        }
+        if (changed.empty()) continue;
+
+        auto t0 = std::chrono::steady_clock::now();
+        bool loaded = engine_.loadVoiceFromFile(changed);
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+
+        if (loaded) {
+            std::cout << "Reloaded " << changed
+                      << " (" << us / 1000.0 << " ms)\n";
+        } else {
+            std::cerr << "Reload failed: " << changed << "\n";
+        }
+    }
+}
+
+#else // !__linux__
+
+bool VoiceWatcher::addWatch(const std::string&) {
+    return false;
+}
+
+bool VoiceWatcher::start() {
+    std::cerr << "Live reload needs inotify (Linux only); disabled.\n";
+    return false;
+}
+
+void VoiceWatcher::stop() {
+}
+
+void VoiceWatcher::run() {
+}
+
+#endif
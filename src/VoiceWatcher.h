@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class DX7Engine;
+
+// Live reload: watches the auditioned voice file (and optionally a directory
+// of .syx files) with inotify and loads a file into the engine whenever it is
+// written. The watcher thread sleeps in poll() until something changes; the
+// engine swaps the new voice in at the next render block, so audio and MIDI
+// keep running.
+//
+// Only available on Linux; elsewhere start() reports that it is disabled.
+class VoiceWatcher {
+public:
+    // Either argument may be empty.
+    VoiceWatcher(DX7Engine& engine,
+                 const std::string& voicePath,
+                 const std::string& watchDir = "");
+    ~VoiceWatcher();
+
+    // Returns false if nothing could be watched.
+    bool start();
+    void stop();
+
+private:
+    DX7Engine&  engine_;
+    std::string voiceDir_;   // directory and name of the --voice file;
+    std::string voiceName_;  // editors often save by renaming over it
+    std::string watchDir_;
+
+    int inotifyFd_ = -1;
+    int wakeFd_    = -1;   // eventfd used by stop() to wake the thread
+    std::thread thread_;
+
+    // inotify watch descriptor -> watched directory
+    std::vector<std::pair<int, std::string>> watches_;
+
+    bool addWatch(const std::string& dir);
+    bool wantsFile(const std::string& dir, const std::string& name) const;
+    void run();
+
+    VoiceWatcher(const VoiceWatcher&) = delete;
+    VoiceWatcher& operator=(const VoiceWatcher&) = delete;
+};
@@ -0,0 +1,106 @@
+#include "WorkStealingPool.h"
+
+#include <deque>
+
+struct WorkStealingPool::WorkQueue {
+    std::mutex              mutex;
+    std::deque<std::size_t> items;
+
+    bool popBack(std::size_t& item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty()) return false;
+        item = items.back();
+        items.pop_back();
+        return true;
+    }
+
+    bool stealFront(std::size_t& item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty()) return false;
+        item = items.front();
+        items.pop_front();
+        return true;
+    }
+};
+
+WorkStealingPool::WorkStealingPool(unsigned int threads)
+    : threads_(threads ? threads : 1)
+{
+    for (unsigned int w = 0; w < threads_; ++w) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned int w = 1; w < threads_; ++w) {
+        workers_.emplace_back(&WorkStealingPool::workerLoop, this, w);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+void WorkStealingPool::run(std::size_t count, const Job& fn) {
+    // The workers are all asleep between runs, so the queues can be refilled
+    // without coordination.
+    for (unsigned int w = 0; w < threads_; ++w) {
+        std::size_t begin = count * w / threads_;
+        std::size_t end   = count * (w + 1) / threads_;
+        // Reverse order so popBack() walks the range front to back.
+        for (std::size_t i = end; i > begin; --i) queues_[w]->items.push_back(i - 1);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_  = &fn;
+        busy_ = threads_ - 1;
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    drain(0, fn);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return busy_ == 0; });
+    job_ = nullptr;
+}
+
+void WorkStealingPool::workerLoop(unsigned int self) {
+    uint64_t seen = 0;
+    for (;;) {
+        const Job* job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            job  = job_;
+        }
+
+        drain(self, *job);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busy_ == 0) done_.notify_one();
+    }
+}
+
+void WorkStealingPool::drain(unsigned int self, const Job& fn) {
+    std::size_t item;
+    for (;;) {
+        if (queues_[self]->popBack(item)) {
+            fn(self, item);
+            continue;
+        }
+
+        bool stole = false;
+        for (unsigned int k = 1; k < threads_ && !stole; ++k) {
+            stole = queues_[(self + k) % threads_]->stealFront(item);
+        }
+        if (!stole) return; // everything is taken; nothing gets re-queued
+
+        fn(self, item);
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Minimal work-stealing pool.
+//
+// The worker threads are started once and sleep between run() calls. run()
+// splits [0, count) into one contiguous range per worker. Each worker takes
+// items from the back of its own deque and, once that is empty, steals
+// single items from the front of the others, so uneven item costs (a long
+// release tail vs. a voice that is rejected early) balance out. The calling
+// thread works as worker 0.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned int threads);
+    ~WorkStealingPool();
+
+    unsigned int threads() const { return threads_; }
+
+    // Calls fn(workerIndex, item) once for every item; blocks until done.
+    // Not reentrant: one run() at a time.
+    void run(std::size_t count,
+             const std::function<void(unsigned int, std::size_t)>& fn);
+
+private:
+    struct WorkQueue;
+    using Job = std::function<void(unsigned int, std::size_t)>;
+
+    unsigned int                            threads_;
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread>                workers_;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;  // a new run() or shutdown
+    std::condition_variable done_;  // the last worker finished its share
+    const Job*              job_        = nullptr;
+    uint64_t                generation_ = 0;  // bumped by every run()
+    unsigned int            busy_       = 0;  // workers still in this run()
+    bool                    stop_       = false;
+
+    void workerLoop(unsigned int self);
+    void drain(unsigned int self, const Job& fn);
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+};
@@ -1,11 +1,30 @@
 #include "DX7Engine.h"
 #include "AudioRtBackend.h"
 #include "MidiRtBackend.h"
+#include "LatencyTracer.h"
+#include "VoiceWatcher.h"
+#include "GoldenAudio.h"
+#include "LibraryBrowser.h"
+#include "VoiceBreeder.h"
+#include "VoiceLibrary.h"
 
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <csignal>
 #include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+volatile std::sig_atomic_t g_quit = 0;
+
+void onSignal(int) {
+    g_quit = 1;
+}
+
+} // namespace
 
 void printHelp() {
     std::cout <<
@@ -16,6 +35,22 @@ void printHelp() {
 "  --voice <file.syx>        Load a specific DX7 voice file\n"
 "  --midi-port <index>       Open a specific MIDI input port\n"
 "  --velocity-curve <name>   Set velocity curve: linear, soft, hard\n"
+"  --watch                   Reload the --voice file whenever it is saved\n"
+"  --watch-dir <dir>         Load any .syx file saved into <dir>\n"
+"  --library <dir>           Browse the .syx files in <dir> with instant\n"
+"                            pre-rendered previews (commands on stdin)\n"
+"  --preview-cache <file>    Preview cache file (default <dir>/.dx7preview.cache)\n"
+"  --breed <dir>             Generate new voices from --voice/--library\n"
+"                            parents, render-test them and write the\n"
+"                            survivors to <dir>, then exit\n"
+"  --breed-count <n>         Number of candidates (default 1000)\n"
+"  --breed-seed <n>          Random seed (default 1)\n"
+"  --breed-threads <n>       Worker threads (default: all cores)\n"
+"  --trace <file.json>       Trace MIDI-to-audio latency; write a Chrome\n"
+"                            trace and print percentiles on exit\n"
+"  --golden <dir>            Render the golden-audio corpus offline, compare\n"
+"                            it with the references in <dir> and exit\n"
+"  --golden-update           With --golden: (re)write the references\n"
 "  --help                    Show this help message\n\n";
 }
 
@@ -23,6 +58,14 @@ int main(int argc, char** argv) {
     std::string syxPath;
     int midiPortOverride = -1;
     std::string velCurveName = "linear";
+    std::string tracePath;
+    bool watchVoice = false;
+    std::string watchDir;
+    std::string goldenDir;
+    bool goldenUpdate = false;
+    std::string libraryDir;
+    std::string previewCachePath;
+    BreedOptions breed;
 
     for (int i = 1; i < argc; ++i) {
         if (!strcmp(argv[i], "--help")) {
@@ -38,6 +81,39 @@ int main(int argc, char** argv) {
         else if (!strcmp(argv[i], "--velocity-curve") && i + 1 < argc) {
             velCurveName = argv[++i];
         }
+        else if (!strcmp(argv[i], "--watch")) {
+            watchVoice = true;
+        }
+        else if (!strcmp(argv[i], "--watch-dir") && i + 1 < argc) {
+            watchDir = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--library") && i + 1 < argc) {
+            libraryDir = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--preview-cache") && i + 1 < argc) {
+            previewCachePath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--breed") && i + 1 < argc) {
+            breed.outDir = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--breed-count") && i + 1 < argc) {
+            breed.count = std::stoul(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--breed-seed") && i + 1 < argc) {
+            breed.seed = std::stoull(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--breed-threads") && i + 1 < argc) {
+            breed.threads = static_cast<unsigned int>(std::stoul(argv[++i]));
+        }
+        else if (!strcmp(argv[i], "--trace") && i + 1 < argc) {
+            tracePath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--golden") && i + 1 < argc) {
+            goldenDir = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--golden-update")) {
+            goldenUpdate = true;
+        }
         else {
             std::cerr << "Unknown option: " << argv[i] << "\n";
             printHelp();
@@ -45,11 +121,40 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (!goldenDir.empty()) {
+        return runGoldenAudio(goldenDir, goldenUpdate);
+    }
+
     const double sampleRate = 48000.0;
     const unsigned int bufferFrames = 256;
 
+    if (!breed.outDir.empty()) {
+        std::vector<std::array<uint8_t, 155>> parents;
+        if (!libraryDir.empty()) {
+            for (const auto& v : loadVoiceLibrary(libraryDir)) {
+                parents.push_back(v.data);
+            }
+        }
+        if (!syxPath.empty()) {
+            std::vector<LibraryVoice> voices;
+            if (loadVoiceFile(syxPath, voices)) {
+                for (const auto& v : voices) parents.push_back(v.data);
+            } else {
+                std::cerr << "Failed to load .syx file: " << syxPath << "\n";
+            }
+        }
+        breed.sampleRate = sampleRate;
+        return runVoiceBreeder(parents, breed);
+    }
+
     try {
+        std::unique_ptr<LatencyTracer> tracer;
+        if (!tracePath.empty()) {
+            tracer = std::make_unique<LatencyTracer>();
+        }
+
         DX7Engine engine(sampleRate, 16);
+        engine.setTracer(tracer.get());
 
         // Choose velocity curve
         VelocityCurve curve = VelocityCurve::LinearFull;
@@ -62,29 +167,88 @@ int main(int argc, char** argv) {
         }
         engine.setVelocityCurve(curve);
 
+        // The browser owns its own preview engine; create it before audio
+        // starts so the two engines are never constructed concurrently.
+        std::unique_ptr<LibraryBrowser> browser;
+        if (!libraryDir.empty()) {
+            browser = std::make_unique<LibraryBrowser>(
+                engine, libraryDir, previewCachePath, sampleRate);
+            if (!browser->open()) browser.reset();
+        }
+
         if (!syxPath.empty()) {
             if (!engine.loadVoiceFromFile(syxPath)) {
                 std::cerr << "Failed to load .syx file: " << syxPath << "\n";
             }
-        } else {
+        } else if (!browser) {
             std::cout << "No .syx file specified; using init voice.\n";
         }
 
-        AudioRtBackend audio(engine, sampleRate, bufferFrames);
-        audio.start();
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+
+        {
+            AudioRtBackend audio(engine, sampleRate, bufferFrames, tracer.get());
+            if (browser) audio.setPreviewPlayer(browser->player());
+            audio.start();
 
-        MidiRtBackend midi(engine, midiPortOverride);
+            MidiRtBackend midi(engine, midiPortOverride, tracer.get());
 
-        std::cout << "DX7SoloAudition running at " << sampleRate << " Hz.\n"
-                  << "Velocity curve: " << velCurveName << "\n"
-                  << "Ctrl+C to quit.\n";
+            std::unique_ptr<VoiceWatcher> watcher;
+            if ((watchVoice && !syxPath.empty()) || !watchDir.empty()) {
+                watcher = std::make_unique<VoiceWatcher>(
+                    engine, watchVoice ? syxPath : std::string(), watchDir);
+                if (watcher->start()) {
+                    std::cout << "Watching for voice changes.\n";
+                }
+            } else if (watchVoice) {
+                std::cerr << "--watch needs --voice; ignoring.\n";
+            }
+
+            std::cout << "DX7SoloAudition running at " << sampleRate << " Hz.\n"
+                      << "Velocity curve: " << velCurveName << "\n"
+                      << "Ctrl+C to quit.\n";
+
+            if (browser) browser->start();
+
+            // The browser polls stdin and pending previews; otherwise the
+            // loop only reports status.
+            const auto tick = std::chrono::milliseconds(browser ? 10 : 100);
+
+            uint32_t singles = 0, banks = 0, errors = 0;
+            while (!g_quit) {
+                std::this_thread::sleep_for(tick);
 
-        for (;;) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                if (browser && !browser->poll()) break;
+
+                if (midi.singleVoicesReceived() != singles) {
+                    singles = midi.singleVoicesReceived();
+                    std::cout << "Received SysEx single voice.\n";
+                }
+                if (midi.banksReceived() != banks) {
+                    banks = midi.banksReceived();
+                    std::cout << "Received SysEx 32-voice bank; playing voice 1, "
+                                 "use program change to select.\n";
+                }
+                if (midi.sysexErrors() != errors) {
+                    errors = midi.sysexErrors();
+                    std::cerr << "Rejected malformed SysEx voice dump "
+                                 "(bad length or checksum).\n";
+                }
+            }
+        } // backends stopped here; tracer buffers are now quiescent
+
+        if (tracer) {
+            tracer->printSummary(std::cout);
+            if (tracer->writeChromeTrace(tracePath)) {
+                std::cout << "Wrote latency trace to " << tracePath << "\n";
+            }
         }
     }
     catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << "\n";
         return 1;
     }
+
+    return 0;
 }